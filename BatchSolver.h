@@ -0,0 +1,203 @@
+#ifndef BATCHSOLVER_H
+#define BATCHSOLVER_H
+
+// Batch solver for many independent tasks (e.g. the scenarios of a what-if analysis)
+// Every task is solved by the usual engine, serially, on one worker thread with its own SolveContext,
+// so the workers run different tasks at the same time. The parallelism is across tasks instead of
+// inside a solve: a small task gives a population-wide parallel loop too little work per thread, while
+// whole solves never wait for each other. Throughput grows with the number of cores.
+//
+// Scheduling is work stealing: the jobs are sorted by size (genes per individual), dealt round-robin
+// to one deque per worker, and each worker takes the largest job at the front of its own deque. A worker
+// whose deque is empty steals the smallest job at the back of another one, so the large jobs start first
+// and the small ones fill the gaps at the end of the batch.
+//
+// Job k runs with its own seed forked from GAConfig::seed, so the results do not depend on the number
+// of workers or on which worker ran a job (unless a time budget ends a run).
+//
+// Constants and Macros:
+// - BATCH_WORKERS: Default number of worker threads (0 -> one per hardware thread).
+
+#include "GeneticAlgorithm.h"
+#include <chrono>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#define BATCH_WORKERS 0
+
+using namespace std;
+
+// One task of a batch
+struct BatchJob
+{
+    Task task;
+    double timeBudget = 0; // Seconds, 0 -> the timeBudget of the batch config
+};
+
+// Outcome of one job, results[k] belongs to jobs[k]
+struct BatchResult
+{
+    SolutionSnapshot best; // Best solution of the run, feasible first
+    vector<SolutionSnapshot> paretoFront; // Final non-dominated set, multi-objective mode only
+    uint64_t seed = 0; // Seed the job ran with, rerunning geneticAlgorithm() with it gives the same result
+    double seconds = 0; // Time of the solve, the wait in the queue excluded
+    unsigned int worker = 0; // Worker thread that ran the job
+};
+
+// Job indices of one worker. Jobs take milliseconds or more, so a plain lock is never held for long.
+class StealQueue
+{
+    private:
+    mutex queueMutex;
+    deque<unsigned int> jobs;
+
+    public:
+    // Methods
+    void push(unsigned int job); // Appends a job, only called before the workers start.
+    bool take(unsigned int& job); // Owner: pops the front, false if empty.
+    bool steal(unsigned int& job); // Other workers: pops the back, false if empty.
+};
+
+// Time Complexity: O(1) amortized
+// Space Complexity: O(1) amortized
+void StealQueue::push(unsigned int job)
+{
+    lock_guard<mutex> lock(queueMutex);
+    jobs.push_back(job);
+}
+
+// Time Complexity: O(1)
+// Space Complexity: O(1)
+bool StealQueue::take(unsigned int& job)
+{
+    lock_guard<mutex> lock(queueMutex);
+    if (jobs.empty()) {
+        return false;
+    }
+    job = jobs.front();
+    jobs.pop_front();
+    return true;
+}
+
+// Time Complexity: O(1)
+// Space Complexity: O(1)
+bool StealQueue::steal(unsigned int& job)
+{
+    lock_guard<mutex> lock(queueMutex);
+    if (jobs.empty()) {
+        return false;
+    }
+    job = jobs.back();
+    jobs.pop_back();
+    return true;
+}
+
+// Next job of a worker: its own deque first, then the other deques starting with its right neighbour
+// No job is added once the workers run, so a worker that finds every deque empty is done.
+// Time Complexity: O(W), W stands for the number of workers
+// Space Complexity: O(1)
+bool nextBatchJob(unsigned int worker, vector<unique_ptr<StealQueue>>& queues, unsigned int& job)
+{
+    if (queues[worker]->take(job)) {
+        return true;
+    }
+    for (size_t k = 1; k < queues.size(); k++) {
+        if (queues[(worker + k) % queues.size()]->steal(job)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Main loop of one worker: solves jobs until every deque is empty
+// config: the batch config, already stripped of its output and shared pointers by solveBatch()
+// Time Complexity: O(sum of the solves it runs)
+// Space Complexity: O(P * S * C) of the largest task it solves
+void runBatchWorker(unsigned int worker, const vector<BatchJob>& jobs, const GAConfig& config,
+                    vector<unique_ptr<StealQueue>>& queues, vector<BatchResult>& results)
+{
+    typedef chrono::steady_clock Clock;
+    ThreadPool pool(1); // No threads: each solve runs on the worker itself
+    RandomStreams streams(config.seed);
+    unsigned int job;
+    while (nextBatchJob(worker, queues, job)) {
+        BatchResult& result = results[job];
+        GAConfig jobConfig = config;
+        BestSolution best;
+        jobConfig.bestSolution = &best;
+        jobConfig.paretoFront = config.multiObjective ? &result.paretoFront : nullptr;
+        jobConfig.seed = streams.fork(job).getSeed();
+        if (jobs[job].timeBudget > 0) {
+            jobConfig.timeBudget = jobs[job].timeBudget;
+        }
+
+        Clock::time_point start = Clock::now();
+        geneticAlgorithm(jobs[job].task, jobConfig, pool);
+        result.seconds = chrono::duration<double>(Clock::now() - start).count();
+        result.best = best.snapshot();
+        result.seed = jobConfig.seed;
+        result.worker = worker;
+    }
+}
+
+// Solves every job of a batch with the settings of config and returns one result per job, in job order
+// config.numThreads is not used: each job runs serially on one of numWorkers threads (0 -> one per
+// hardware thread, the calling thread is one of them). Logging, printing, profiling, telemetry, warm
+// starts and the bestSolution / onImprovement / paretoFront outputs of config are ignored, each job
+// reports through its BatchResult instead.
+// Time Complexity: O(J log J + sum over the jobs of G * P * S * C / W), J stands for jobs, W for workers
+// Space Complexity: O(J * S * C + W * P * S * C)
+vector<BatchResult> solveBatch(const vector<BatchJob>& jobs, const GAConfig& config, unsigned int numWorkers = BATCH_WORKERS)
+{
+    vector<BatchResult> results(jobs.size());
+    if (jobs.empty()) {
+        return results;
+    }
+    if (numWorkers == 0) {
+        numWorkers = max(1u, thread::hardware_concurrency());
+    }
+    numWorkers = min<size_t>(numWorkers, jobs.size());
+
+    GAConfig batchConfig = config;
+    batchConfig.verbose = false;
+    batchConfig.printBest = false;
+    batchConfig.profile = false;
+    batchConfig.telemetry = nullptr;
+    batchConfig.population = nullptr;
+    batchConfig.bestSolution = nullptr;
+    batchConfig.onImprovement = nullptr;
+    batchConfig.paretoFront = nullptr;
+
+    // Largest jobs first, dealt round-robin so every worker starts with a similar share
+    vector<unsigned int> order(jobs.size());
+    vector<unsigned int> genes(jobs.size());
+    for (unsigned int k = 0; k < jobs.size(); k++) {
+        order[k] = k;
+        genes[k] = jobs[k].task.getNumGenes();
+    }
+    stable_sort(order.begin(), order.end(), [&genes](unsigned int a, unsigned int b) {
+        return genes[a] > genes[b];
+    });
+    vector<unique_ptr<StealQueue>> queues;
+    for (unsigned int w = 0; w < numWorkers; w++) {
+        queues.emplace_back(new StealQueue());
+    }
+    for (size_t k = 0; k < order.size(); k++) {
+        queues[k % numWorkers]->push(order[k]);
+    }
+
+    vector<thread> workers;
+    for (unsigned int w = 1; w < numWorkers; w++) {
+        workers.emplace_back(runBatchWorker, w, cref(jobs), cref(batchConfig), ref(queues), ref(results));
+    }
+    runBatchWorker(0, jobs, batchConfig, queues, results);
+    for (thread& worker : workers) {
+        worker.join();
+    }
+    return results;
+}
+
+#endif
@@ -0,0 +1,430 @@
+// Microbenchmarks of the genetic algorithm hot paths
+// Runs every operator on synthetic instances from 10 x 10 up to 1000 servers x 10000 clients (plus
+// a sparse 1000 x 100000 instance where each client reaches 4 servers) and
+// reports ns per individual, generations per second of the whole engine and heap allocations per
+// generation. The population of each instance is shrunk so one population stays around
+// BENCH_GENE_BUDGET genes, which keeps the largest instance within a few hundred MB.
+// A last section compares the penalty policies on instances of different latency scales and capacity
+// tightness, with repair, local search and heuristic seeds off: generations until the best individual
+// is feasible, until its latency score is within 1% of its final value, that final value, and the
+// feasible share of the population.
+// The batch section solves many small instances one after another with the whole pool, then with
+// solveBatch(), and reports instances per second of both.
+//
+// Usage: Benchmark [maxGenes] [minSeconds]
+// - maxGenes: skip instances with more than maxGenes genes per individual (default: run all).
+//   The genes of a sparse instance are its reachable pairs.
+// - minSeconds: minimum time spent on each measurement (default BENCH_MIN_SECONDS).
+//
+// Constants and Macros:
+// - BENCH_GENE_BUDGET: Genes per benchmark population (population = BENCH_GENE_BUDGET / (S * C), at most POPULATION).
+// - BENCH_MIN_SECONDS: Minimum time of each measurement, repetitions are added until it is reached.
+// - BENCH_GENERATIONS: Maximum generations timed for the engine measurements.
+// - BENCH_PENALTY_GENERATIONS: Generations of each penalty policy run.
+// - BENCH_PENALTY_POPULATION: Population of the penalty policy runs.
+// - BENCH_CREEP_RATE: Share of the genes changed by each mutation of the penalty policy runs.
+// - BENCH_BATCH_JOBS: Instances of the batch section.
+// - BENCH_BATCH_GENERATIONS, BENCH_BATCH_POPULATION: Settings of each of these solves.
+
+#define PROFILE_ALLOCATIONS 1 // Heap allocations are counted by the replaced operator new of Profiler.h
+
+#include "BatchSolver.h"
+#include <atomic>
+#include <chrono>
+#include <numeric>
+
+#define BENCH_GENE_BUDGET (1u << 24)
+#define BENCH_MIN_SECONDS 0.2
+#define BENCH_GENERATIONS 50
+#define BENCH_PENALTY_GENERATIONS 1500
+#define BENCH_PENALTY_POPULATION 100
+#define BENCH_CREEP_RATE 0.2
+#define BENCH_BATCH_JOBS 64
+#define BENCH_BATCH_GENERATIONS 100
+#define BENCH_BATCH_POPULATION 50
+
+using namespace std;
+
+SolveContext benchContext; // Context of the instance being measured, bound to the main thread by main()
+
+// Builds a synthetic task with random latencies, bandwidths and capacities into benchContext
+// reachable: servers each client can reach (0 -> all of them, dense task)
+// latencyScale: multiplies every latency (the latencies are drawn in [1, 50) * latencyScale)
+// capacityShare: 0 -> roughly half of a random allocation fits, otherwise the capacities add up to
+// capacityShare times the bandwidths (below 1 the ideal allocation does not fit)
+// Time Complexity: O(S * C), O(S + C * R) for a sparse task
+// Space Complexity: O(S * C), O(S + C * R) for a sparse task
+void setupInstance(unsigned int numServers, unsigned int numClients, unsigned int reachable, uint64_t seed,
+                   double latencyScale = 1.0, double capacityShare = 0)
+{
+    Rng rng(seed);
+    Task& task = benchContext.task;
+    if (reachable == 0) {
+        vector<vector<double>> latencies(numServers, vector<double>(numClients));
+        for (unsigned int i = 0; i < numServers; i++) {
+            for (unsigned int j = 0; j < numClients; j++) {
+                latencies[i][j] = (1.0 + 49.0 * rng.uniform()) * latencyScale; // Latencies must be positive
+            }
+        }
+        task = Task(numServers, numClients, latencies);
+    } else {
+        // Client j reaches a window of servers around a random region, rows are built with a counting pass
+        vector<unsigned int> region(numClients);
+        vector<unsigned int> edgeStart(numServers + 1, 0);
+        for (unsigned int j = 0; j < numClients; j++) {
+            region[j] = rng.bounded(numServers);
+            for (unsigned int r = 0; r < reachable; r++) {
+                edgeStart[(region[j] + r) % numServers + 1]++;
+            }
+        }
+        for (unsigned int i = 0; i < numServers; i++) {
+            edgeStart[i + 1] += edgeStart[i];
+        }
+        vector<unsigned int> next(edgeStart.begin(), edgeStart.end() - 1);
+        vector<unsigned int> edgeClients(edgeStart[numServers]);
+        vector<double> latencies(edgeStart[numServers]);
+        for (unsigned int j = 0; j < numClients; j++) {
+            for (unsigned int r = 0; r < reachable; r++) {
+                unsigned int k = next[(region[j] + r) % numServers]++;
+                edgeClients[k] = j; // Clients are visited in order, so every row stays sorted
+                latencies[k] = (1.0 + 49.0 * rng.uniform()) * latencyScale;
+            }
+        }
+        task = Task(numServers, numClients, edgeStart, edgeClients, latencies);
+    }
+
+    double totalBandwith = 0;
+    for (unsigned int j = 0; j < numClients; j++) {
+        task.setBandwith(j, 10 + rng.bounded(40));
+        totalBandwith += task.getBandwith(j);
+    }
+    for (unsigned int i = 0; i < numServers; i++) {
+        if (capacityShare > 0) {
+            task.setCapacity(i, (unsigned int)(capacityShare * totalBandwith / numServers) + 1);
+        } else {
+            task.setCapacity(i, 25 * (task.getNumGenes() / numServers) / 2 + 1);
+        }
+    }
+    task.freeze();
+    findUpperBound();
+}
+
+// Runs body(repetition) until minSeconds have passed (at least once), returns the ns per repetition
+// Time Complexity: O(R) calls of body
+// Space Complexity: O(1)
+template <class Body>
+double timeIt(double minSeconds, const Body& body)
+{
+    typedef chrono::steady_clock Clock;
+    Clock::time_point start = Clock::now();
+    unsigned long long repetitions = 0;
+    double elapsed = 0;
+    do {
+        body(repetitions++);
+        elapsed = chrono::duration<double>(Clock::now() - start).count();
+    } while (elapsed < minSeconds);
+    return elapsed * 1e9 / repetitions;
+}
+
+// Marks every individual as changed so the next evaluate() runs the fitness kernel on all of them
+// Time Complexity: O(P)
+// Space Complexity: O(1)
+void invalidate(Population& pop)
+{
+    for (Chromosome& individual : pop.individuals) {
+        individual.cacheValid = false;
+        individual.modified = true;
+    }
+}
+
+// Prints one result line
+// Time Complexity: O(1)
+// Space Complexity: O(1)
+void report(const string& name, double value, const string& unit)
+{
+    cout << "  " << left << setw(34) << name << right << setw(16) << fixed << setprecision(1) << value << " " << unit << endl;
+}
+
+// Times a whole generation of one engine instantiation: generations/sec and allocations per generation
+// Time Complexity: O(G * P * S * C / T)
+// Space Complexity: O(P * S * C)
+template <class Engine>
+void benchmarkEngine(const string& name, ThreadPool* pool, unsigned int popSize, double minSeconds)
+{
+    Engine engine(RandomStreams(1), pool, popSize);
+    engine.initialize();
+    engine.step(0); // Warm up: buffers reach their final size
+
+    unsigned int generation = 1;
+    unsigned long long allocationsBefore = profileAllocationCount.load();
+    double nsPerGeneration = timeIt(minSeconds, [&](unsigned long long) {
+        engine.step(generation++ % BENCH_GENERATIONS + 1);
+    });
+    double allocationsPerGeneration = (double)(profileAllocationCount.load() - allocationsBefore) / (generation - 1);
+
+    report(name, 1e9 / nsPerGeneration, "generations/s");
+    report(name + " allocations", allocationsPerGeneration, "per generation");
+}
+
+// Runs every microbenchmark on one instance size
+// Time Complexity: O(R * P * S * C), R stands for repetitions
+// Space Complexity: O(P * S * C)
+void benchmarkInstance(unsigned int numServers, unsigned int numClients, unsigned int reachable, double minSeconds, ThreadPool& pool)
+{
+    setupInstance(numServers, numClients, reachable, 12345);
+    size_t genes = benchContext.task.getNumGenes();
+    unsigned int popSize = max<size_t>(4, min<size_t>(POPULATION, BENCH_GENE_BUDGET / genes)) & ~1u;
+    StaticPenalty penalty;
+
+    cout << endl << numServers << " servers x " << numClients << " clients";
+    if (reachable) {
+        cout << " (sparse, " << reachable << " servers per client)";
+    }
+    cout << ", population " << popSize << ", kernel " << (reachable ? "sparse" : fitnessKernelName(fitnessKernel)) << endl;
+
+    RandomStreams streams(7);
+    Population pop(popSize, numServers, numClients, genes);
+    for (unsigned int k = 0; k < popSize; k++) {
+        Rng rng = streams.stream(PHASE_INITIALIZATION, 0, k);
+        generateIndividual(pop[k], rng);
+    }
+    evaluate(pop, penalty, nullptr, true);
+
+    // Kernel against the scalar reference, a benchmark of a wrong kernel is meaningless
+    // (latency score only, KernelCheck.cpp compares every output of every kernel and fails on a mismatch)
+    double worstError = 0;
+    for (unsigned int k = 0; k < popSize; k++) {
+        Chromosome reference = pop[k];
+        calculateLatencyScore(reference);
+        worstError = max(worstError, fabs(reference.latencyScore - pop[k].latencyScore) / max(1.0, fabs(reference.latencyScore)));
+    }
+    cout << "  kernel vs scalar reference: worst relative error " << scientific << setprecision(2) << worstError << endl;
+
+    double ns = timeIt(minSeconds, [&](unsigned long long) {
+        invalidate(pop);
+        evaluate(pop, penalty, nullptr, true);
+    });
+    report("evaluate (full, serial)", ns / popSize, "ns/individual");
+
+    ns = timeIt(minSeconds, [&](unsigned long long) {
+        invalidate(pop);
+        evaluate(pop, penalty, &pool, true);
+    });
+    report("evaluate (full, " + to_string(pool.size()) + " threads)", ns / popSize, "ns/individual");
+
+    unsigned int next = 0;
+    ns = timeIt(minSeconds, [&](unsigned long long) {
+        calculateLatencyScore(pop[next++ % popSize]);
+    });
+    report("calculateLatencyScore", ns, "ns/individual");
+
+    ns = timeIt(minSeconds, [&](unsigned long long) {
+        calculatePenalty(pop[next++ % popSize]);
+    });
+    report("calculatePenalty", ns, "ns/individual");
+
+    // The operators below change genes in place, the population drifts but keeps its shape
+    ns = timeIt(minSeconds, [&](unsigned long long repetition) {
+        Rng rng = streams.stream(PHASE_VARIATION, repetition, 0);
+        unsigned int i = 2 * (next++ % (popSize / 2));
+        BlxAlphaCrossover::apply(pop[i], pop[i + 1], rng);
+    });
+    report("crossover (BLX-alpha)", ns / 2, "ns/individual");
+
+    ns = timeIt(minSeconds, [&](unsigned long long repetition) {
+        Rng rng = streams.stream(PHASE_VARIATION, repetition, 1);
+        unsigned int i = 2 * (next++ % (popSize / 2));
+        SbxCrossover::apply(pop[i], pop[i + 1], rng);
+    });
+    report("crossover (SBX)", ns / 2, "ns/individual");
+
+    ns = timeIt(minSeconds, [&](unsigned long long repetition) {
+        Rng rng = streams.stream(PHASE_VARIATION, repetition, 2);
+        RandomMutation::apply(pop[next++ % popSize], rng);
+    });
+    report("mutation", ns, "ns/individual");
+
+    evaluate(pop, penalty, nullptr, true);
+    vector<unsigned int> matingPool;
+    ns = timeIt(minSeconds, [&](unsigned long long repetition) {
+        BinaryTournamentSelection::select(pop, matingPool, streams, repetition);
+    });
+    report("selection (binary tournament)", ns / popSize, "ns/individual");
+
+    Population offspring(pop);
+    vector<unsigned int> order;
+    ns = timeIt(minSeconds, [&](unsigned long long) {
+        ElitistSurvivor::apply(offspring, pop, order);
+    });
+    report("survivor (elitist)", ns / popSize, "ns/individual");
+
+    ns = timeIt(minSeconds, [&](unsigned long long) {
+        GenerationalSurvivor::apply(offspring, pop, order);
+    });
+    report("survivor (generational)", ns / popSize, "ns/individual");
+
+    // Whole generations with the default operators, serial and on the pool
+    typedef GeneticAlgorithm<BinaryTournamentSelection, SbxCrossover, RandomMutation, ElitistSurvivor, StaticPenalty> DefaultEngine;
+    benchmarkEngine<DefaultEngine>("generation (serial)", nullptr, popSize, minSeconds);
+    benchmarkEngine<DefaultEngine>("generation (" + to_string(pool.size()) + " threads)", &pool, popSize, minSeconds);
+}
+
+// Mutation of the penalty runs: each gene is scaled by a random factor in [0.5, 1.5) with probability
+// BENCH_CREEP_RATE, a zero gene restarts at a small positive value. The default random mutation redraws
+// half of the genes, so without repair it keeps undoing what the selection fixed and no policy ever
+// reaches a feasible individual, while scaling lets the loads shrink towards the bounds.
+struct CreepMutation
+{
+    static void apply(Chromosome& off1, Rng& rng); // Mutates a chromosome.
+};
+
+// Time Complexity: O(S * C), O(E) if sparse
+// Space Complexity: O(1)
+void CreepMutation::apply(Chromosome& off1, Rng& rng)
+{
+    GeneLayout layout = geneLayout();
+    for (unsigned int i = 0; i < off1.numServers; i++) {
+        for (unsigned int k = layout.edgeStart[i]; k < layout.edgeStart[i + 1]; k++) {
+            if (rng.uniform() >= BENCH_CREEP_RATE) {
+                continue;
+            }
+            unsigned int j = layout.client(i, k);
+            unsigned int bound = activeSolve->upperBounds[j];
+            double gene = off1.ServerAllocations[k];
+            double value = gene > 0 ? gene * (0.5 + rng.uniform()) : 1 + rng.bounded(max(1u, bound / 10));
+            updateGene(off1, k, i, j, min(value, (double)bound));
+        }
+    }
+}
+
+// One run with penalty policy Penalty from a random start, without repair, local search or heuristic
+// seeds, so only the penalties drive the population towards feasibility
+// Reports the generation at which the best individual (feasible first) became feasible, the generation
+// from which its latency score stayed within 1% of the final one, that final latency score, and the
+// feasible share of the population averaged over the run and over its last tenth.
+// Time Complexity: O(G * P * S * C / T)
+// Space Complexity: O(P * S * C + G)
+template <class Penalty>
+void benchmarkPenalty(const string& name, ThreadPool* pool)
+{
+    GeneticAlgorithm<BinaryTournamentSelection, SbxCrossover, CreepMutation, ElitistSurvivor, Penalty> engine(RandomStreams(1), pool, BENCH_PENALTY_POPULATION);
+    MemeticOptions memetic;
+    memetic.repairOffspring = false;
+    memetic.localSearchElites = 0;
+    engine.setMemetic(memetic);
+    engine.initialize(0);
+    vector<double> latencies; // Latency score of the best individual before each generation, NAN while infeasible
+    vector<double> shares; // Feasible share of the population before each generation
+    for (unsigned int generation = 0; generation <= BENCH_PENALTY_GENERATIONS; generation++) {
+        Population& pop = engine.getPopulation();
+        Chromosome& best = reportedBest(pop);
+        latencies.push_back(best.isFeas ? best.latencyScore : NAN);
+        unsigned int feasibleCount = 0;
+        for (unsigned int k = 0; k < pop.size(); k++) {
+            feasibleCount += pop[k].isFeas;
+        }
+        shares.push_back((double)feasibleCount / pop.size());
+        if (generation < BENCH_PENALTY_GENERATIONS) {
+            engine.step(generation);
+        }
+    }
+
+    size_t lastTenth = shares.size() - shares.size() / 10;
+    report(name + " feasible share, run", 100 * accumulate(shares.begin(), shares.end(), 0.0) / shares.size(), "%");
+    report(name + " feasible share, last 10%", 100 * accumulate(shares.begin() + lastTenth, shares.end(), 0.0) / (shares.size() - lastTenth), "%");
+
+    size_t feasible = 0;
+    while (feasible < latencies.size() && std::isnan(latencies[feasible])) {
+        feasible++;
+    }
+    if (feasible == latencies.size()) {
+        cout << "  " << left << setw(34) << name + " feasible after" << right << setw(16) << "never" << endl;
+        return;
+    }
+    double final = latencies.back();
+    size_t converged = latencies.size() - 1;
+    while (converged > feasible && latencies[converged - 1] <= 1.01 * final) {
+        converged--;
+    }
+    report(name + " feasible after", feasible, "generations");
+    report(name + " within 1% after", converged, "generations");
+    cout << "  " << left << setw(34) << name + " final latency score" << right << setw(16) << scientific << setprecision(4) << final << endl;
+}
+
+// Runs every penalty policy on one instance
+// Time Complexity: O(3 * G * P * S * C / T)
+// Space Complexity: O(P * S * C)
+void benchmarkPenalties(unsigned int numServers, unsigned int numClients, double latencyScale, double capacityShare, ThreadPool& pool)
+{
+    setupInstance(numServers, numClients, 0, 12345, latencyScale, capacityShare);
+    cout << endl << defaultfloat << numServers << " servers x " << numClients << " clients, latencies x " << latencyScale
+         << ", capacities " << capacityShare << " x bandwidths, population " << BENCH_PENALTY_POPULATION << endl;
+    benchmarkPenalty<StaticPenalty>("static", &pool);
+    benchmarkPenalty<ScheduledPenalty>("scheduled", &pool);
+    benchmarkPenalty<AdaptivePenalty>("adaptive", &pool);
+}
+
+// Throughput of many small solves: one after another on the whole pool, then spread by solveBatch()
+// Time Complexity: O(2 * J * G * P * S * C / T)
+// Space Complexity: O(J * S * C + T * P * S * C)
+void benchmarkBatch(unsigned int numServers, unsigned int numClients, ThreadPool& pool)
+{
+    typedef chrono::steady_clock Clock;
+    vector<BatchJob> jobs(BENCH_BATCH_JOBS);
+    for (unsigned int k = 0; k < jobs.size(); k++) {
+        setupInstance(numServers, numClients, 0, 1000 + k);
+        jobs[k].task = benchContext.task;
+    }
+    GAConfig config;
+    config.seed = 1;
+    config.generations = BENCH_BATCH_GENERATIONS;
+    config.populationSize = BENCH_BATCH_POPULATION;
+    config.stagnationGenerations = 0;
+    config.verbose = false;
+    config.printBest = false;
+
+    cout << endl << BENCH_BATCH_JOBS << " instances of " << numServers << " servers x " << numClients << " clients, population "
+         << BENCH_BATCH_POPULATION << ", " << BENCH_BATCH_GENERATIONS << " generations" << endl;
+    Clock::time_point start = Clock::now();
+    for (BatchJob& job : jobs) {
+        geneticAlgorithm(job.task, config, pool);
+    }
+    double sequential = chrono::duration<double>(Clock::now() - start).count();
+    start = Clock::now();
+    solveBatch(jobs, config, pool.size());
+    double batch = chrono::duration<double>(Clock::now() - start).count();
+    report("one after another", jobs.size() / sequential, "instances/s");
+    report("solveBatch", jobs.size() / batch, "instances/s");
+}
+
+int main(int argc, char** argv)
+{
+    size_t maxGenes = argc > 1 ? strtoull(argv[1], nullptr, 10) : 0;
+    double minSeconds = argc > 2 ? atof(argv[2]) : BENCH_MIN_SECONDS;
+    unsigned int sizes[][3] = {{10, 10, 0}, {100, 100, 0}, {100, 1000, 0}, {1000, 1000, 0}, {1000, 10000, 0}, {1000, 100000, 4}};
+
+    SolveScope scope(benchContext);
+    ThreadPool pool(WORKER_THREADS);
+    cout << "Fitness kernel: " << fitnessKernelName(fitnessKernel) << ", threads: " << pool.size() << endl;
+    for (auto& size : sizes) {
+        size_t genes = size[2] ? (size_t)size[1] * size[2] : (size_t)size[0] * size[1];
+        if (maxGenes && genes > maxGenes) {
+            continue;
+        }
+        benchmarkInstance(size[0], size[1], size[2], minSeconds, pool);
+    }
+
+    // Penalty policies: small and large latency scales, capacities above and below the bandwidths
+    double penaltyInstances[][4] = {{10, 50, 1, 1.2}, {10, 50, 1, 0.8}, {10, 50, 1000, 0.8}, {30, 150, 1, 0.8}};
+    for (auto& instance : penaltyInstances) {
+        if (maxGenes && instance[0] * instance[1] > maxGenes) {
+            continue;
+        }
+        benchmarkPenalties(instance[0], instance[1], instance[2], instance[3], pool);
+    }
+
+    if (!maxGenes || maxGenes >= 200) {
+        benchmarkBatch(10, 20, pool);
+    }
+    return 0;
+}
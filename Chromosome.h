@@ -1,20 +1,104 @@
+#ifndef CHROMOSOME_H
+#define CHROMOSOME_H
+
+// Chromosomes and the population arena that owns their genes
+// The storage type of a gene is chosen at compile time. Every value an operator computes goes through
+// toGene(), so integer genes are rounded the same way by crossover, mutation, seeding and local search.
+// Loads, scores and penalties are always summed in double, which is exact for integer genes.
+//
+// Constants and Macros:
+// - GENE_TYPE: Storage of a gene (0 -> double, 1 -> float, 2 -> uint32 and 3 -> uint16 units of bandwidth).
+//   Narrower genes shrink the arena and the memory traffic of every pass over it (to 1/2 or 1/4),
+//   uint16 genes cap bandwidths and capacities at 65535 units.
+
+#include <algorithm>
 #include <iostream>
 #include <string>
 #include <cmath>
 #include <ctime>
 #include <cstdlib>
+#include <cstdint>
+#include <cstring>
+#include <limits>
 #include <vector>
 
+#ifndef GENE_TYPE
+#define GENE_TYPE 0 // 0 -> double, 1 -> float, 2 -> uint32, 3 -> uint16
+#endif
+
 using namespace std;
 
+#if GENE_TYPE == 1
+typedef float Gene;
+#elif GENE_TYPE == 2
+typedef uint32_t Gene;
+#elif GENE_TYPE == 3
+typedef uint16_t Gene;
+#else
+typedef double Gene;
+#endif
+
+#define GENE_INTEGER (GENE_TYPE == 2 || GENE_TYPE == 3)
+
+// Largest gene value, integer genes stay below 2^31 so the vector kernels can convert them as signed
+const double geneMaximum = GENE_INTEGER ? min<double>(numeric_limits<Gene>::max(), numeric_limits<int32_t>::max())
+                                        : numeric_limits<Gene>::max();
+
+// Stores a computed allocation as a gene: clamped to [0, geneMaximum], integer genes round to nearest
+// Time Complexity: O(1)
+// Space Complexity: O(1)
+Gene toGene(double value)
+{
+    value = min(max(value, 0.0), geneMaximum);
+    return GENE_INTEGER ? (Gene)floor(value + 0.5) : (Gene)value;
+}
+
+// Stores a computed allocation as the largest gene not above it, so sums scaled below a bound stay below it
+// Time Complexity: O(1)
+// Space Complexity: O(1)
+Gene toGeneFloor(double value)
+{
+    value = min(max(value, 0.0), geneMaximum);
+    if (GENE_INTEGER) {
+        return (Gene)floor(value);
+    }
+    Gene gene = (Gene)value;
+    if (gene > value) {
+        gene = nextafter(gene, (Gene)0); // float rounded up
+    }
+    return gene;
+}
+
 
 // Struct representing a Chromosome in the population
+// A chromosome does not own its genes. It is a lightweight view into the contiguous
+// arena of the Population it belongs to, so copying or swapping a Chromosome only
+// moves the view and its scores, never the allocation matrix itself.
 struct Chromosome
 {
-    // 2D vector to store the server allocations. It represents the allocation of clients
-    // Server1 -> Client1, Client2, ... 
+    // Row-major view of the server allocations. It represents the allocation of clients
+    // Server1 -> Client1, Client2, ...
     // Server2 -> Client1, Client2, ...
-    vector<vector<double>> ServerAllocations;
+    // Dense task: gene (server i, client j) is stored at ServerAllocations[i * numClients + j]
+    // Sparse task: one gene per reachable pair, in the order of the task's edge list (see Task.h)
+    Gene* ServerAllocations;
+
+    // Shape of the allocation matrix the view points to
+    unsigned int numServers;
+    unsigned int numClients;
+    unsigned int numGenes; // numServers * numClients, or the number of reachable pairs of a sparse task
+
+    // Cached evaluation state, also stored in the Population arena.
+    // While cacheValid is true these match the genes, so changing one gene can update
+    // the scores and penalties in O(1) instead of re-evaluating the whole chromosome.
+    double* serverLoads; // Sum of the allocations of each server (numServers values)
+    double* clientLoads; // Sum of the allocations of each client (numClients values)
+    unsigned int zeroCount; // Number of genes equal to 0
+    unsigned int overloadedServers; // Servers whose load exceeds their capacity
+    unsigned int overloadedClients; // Clients whose allocation exceeds their bandwidth
+    bool cacheValid; // False until the first full evaluation, or after an untracked change
+    bool modified; // True if a gene changed since the fitness was last computed
+    unsigned int deltaUpdates; // Incremental updates applied since the last full evaluation
 
     // Latency score of the chromosome.
     double latencyScore;
@@ -23,7 +107,7 @@ struct Chromosome
     // if the server exceeds its capacity due to client allocations.
     double penaltyCapacity;
 
-    // Penalty associated with bandwidth usage. This penalty is applied when the 
+    // Penalty associated with bandwidth usage. This penalty is applied when the
     // total bandwidth usage exceeds the available bandwidth for a client.
     double penaltyBandwith;
 
@@ -31,10 +115,252 @@ struct Chromosome
     double connectionPen;
 
     // Boolean indicating whether the chromosome's configuration is feasible.
-    // If all constraints (capacity, bandwidth, connection) are satisfied, 
+    // If all constraints (capacity, bandwidth, connection) are satisfied,
     // this value will be true; otherwise, it will be false.
     bool isFeas;
 
     // Fitness score of the chromosome. This is the evaluation metric used to determine how good the solution is
     double fitness;
-};
\ No newline at end of file
+
+    // Multi-objective mode (NSGA-II): non-domination rank (0 -> Pareto front) and crowding distance,
+    // set by the survivor selection, both 0 otherwise
+    unsigned int rank;
+    double crowding;
+
+    // Methods
+    Gene& at(unsigned int server, unsigned int client); // Returns the gene of a server-client pair (dense tasks).
+    Gene at(unsigned int server, unsigned int client) const; // Read-only access to a gene (dense tasks).
+    Gene* row(unsigned int server); // Returns the allocations of a server as a contiguous row (dense tasks).
+    const Gene* row(unsigned int server) const; // Read-only access to a row (dense tasks).
+    unsigned int size() const; // Number of genes.
+    void copyFrom(const Chromosome& other); // Copies genes and scores of another chromosome into this view.
+};
+
+// Population arena: owns the genes of every individual in one contiguous buffer
+// Individual k initially views arena[k * G, (k + 1) * G), G is the number of genes per individual
+struct Population
+{
+    vector<Gene> arena; // Genes of all individuals, back to back
+    vector<double> loadArena; // Server and client loads of all individuals, back to back
+    vector<Chromosome> individuals; // Views into the arena
+
+    // Scratch buffers of evaluate(), kept with the arena so evaluating does not allocate
+    vector<pair<uint64_t, unsigned int>> memoKeys; // Gene hash and index of each individual
+    vector<unsigned int> memoSource; // Individual each one copies its evaluation from
+    unsigned int numServers;
+    unsigned int numClients;
+    unsigned int numGenes;
+
+    Population(); // Empty population.
+    Population(unsigned int count, unsigned int numServers, unsigned int numClients, unsigned int numGenes = 0); // Allocates count zeroed individuals, numGenes 0 -> S * C.
+    Population(const Population& other); // Deep copy, views are rebased onto the new arena.
+    Population(Population&& other) = default; // Moving keeps the arena buffer, so views stay valid.
+    Population& operator=(const Population& other);
+    Population& operator=(Population&& other) = default;
+
+    // Methods
+    Chromosome& operator[](size_t index); // Access to an individual.
+    const Chromosome& operator[](size_t index) const;
+    size_t size() const; // Number of individuals.
+};
+
+// Hash of the genes of a chromosome, used to detect identical individuals
+// Time Complexity: O(S * C)
+// Space Complexity: O(1)
+uint64_t hashGenes(const Chromosome& individual)
+{
+    uint64_t hash = 0xCBF29CE484222325ULL ^ individual.size();
+    for (unsigned int g = 0; g < individual.size(); g++) {
+        uint64_t bits = 0;
+        memcpy(&bits, individual.ServerAllocations + g, sizeof(Gene));
+        hash = (hash ^ bits) * 0x100000001B3ULL;
+        hash ^= hash >> 29;
+    }
+    return hash;
+}
+
+// True if two chromosomes of the same shape have exactly the same genes
+// Time Complexity: O(S * C)
+// Space Complexity: O(1)
+bool sameGenes(const Chromosome& a, const Chromosome& b)
+{
+    return memcmp(a.ServerAllocations, b.ServerAllocations, sizeof(Gene) * a.size()) == 0;
+}
+
+// Gene accessor
+// Time Complexity: O(1)
+// Space Complexity: O(1)
+Gene& Chromosome::at(unsigned int server, unsigned int client)
+{
+    return ServerAllocations[server * numClients + client];
+}
+
+// Read-only gene accessor
+// Time Complexity: O(1)
+// Space Complexity: O(1)
+Gene Chromosome::at(unsigned int server, unsigned int client) const
+{
+    return ServerAllocations[server * numClients + client];
+}
+
+// Returns a pointer to the first client allocation of a server
+// Time Complexity: O(1)
+// Space Complexity: O(1)
+Gene* Chromosome::row(unsigned int server)
+{
+    return ServerAllocations + server * numClients;
+}
+
+// Read-only row accessor
+// Time Complexity: O(1)
+// Space Complexity: O(1)
+const Gene* Chromosome::row(unsigned int server) const
+{
+    return ServerAllocations + server * numClients;
+}
+
+// Number of genes in the chromosome
+// Time Complexity: O(1)
+// Space Complexity: O(1)
+unsigned int Chromosome::size() const
+{
+    return numGenes;
+}
+
+// Copies the genes and the evaluation of another chromosome with the same shape.
+// The view of this chromosome is kept, only the data it points to is overwritten.
+// Time Complexity: O(S * C), a single contiguous memcpy (plus O(S + C) for the cached loads)
+// Space Complexity: O(1)
+void Chromosome::copyFrom(const Chromosome& other)
+{
+    if (this == &other || ServerAllocations == other.ServerAllocations) {
+        return;
+    }
+    memcpy(ServerAllocations, other.ServerAllocations, sizeof(Gene) * size());
+    memcpy(serverLoads, other.serverLoads, sizeof(double) * numServers);
+    memcpy(clientLoads, other.clientLoads, sizeof(double) * numClients);
+    zeroCount = other.zeroCount;
+    overloadedServers = other.overloadedServers;
+    overloadedClients = other.overloadedClients;
+    cacheValid = other.cacheValid;
+    modified = other.modified;
+    deltaUpdates = other.deltaUpdates;
+    latencyScore = other.latencyScore;
+    penaltyCapacity = other.penaltyCapacity;
+    penaltyBandwith = other.penaltyBandwith;
+    connectionPen = other.connectionPen;
+    isFeas = other.isFeas;
+    fitness = other.fitness;
+    rank = other.rank;
+    crowding = other.crowding;
+}
+
+// Default constructor: empty population
+// Time Complexity: O(1)
+// Space Complexity: O(1)
+Population::Population()
+{
+    this->numServers = 0;
+    this->numClients = 0;
+    this->numGenes = 0;
+}
+
+// Constructor: allocates the arenas for count individuals, one allocation each for genes and loads
+// Time Complexity: O(P * G), P is the number of individuals, G = S * C or the reachable pairs (zero filling the arena)
+// Space Complexity: O(P * (G + S + C))
+Population::Population(unsigned int count, unsigned int numServers, unsigned int numClients, unsigned int numGenes)
+{
+    this->numServers = numServers;
+    this->numClients = numClients;
+    this->numGenes = numGenes ? numGenes : numServers * numClients;
+
+    size_t genes = this->numGenes;
+    size_t loads = (size_t)numServers + numClients;
+    this->arena = vector<Gene>(genes * count, 0);
+    this->loadArena = vector<double>(loads * count, 0.0);
+    this->individuals = vector<Chromosome>(count);
+
+    for (unsigned int k = 0; k < count; k++) {
+        Chromosome& individual = this->individuals[k];
+        individual.ServerAllocations = this->arena.data() + k * genes;
+        individual.numServers = numServers;
+        individual.numClients = numClients;
+        individual.numGenes = this->numGenes;
+        individual.serverLoads = this->loadArena.data() + k * loads;
+        individual.clientLoads = individual.serverLoads + numServers;
+        individual.zeroCount = 0;
+        individual.overloadedServers = 0;
+        individual.overloadedClients = 0;
+        individual.cacheValid = false;
+        individual.modified = true;
+        individual.deltaUpdates = 0;
+        individual.latencyScore = 0;
+        individual.penaltyCapacity = 0;
+        individual.penaltyBandwith = 0;
+        individual.connectionPen = 0;
+        individual.isFeas = false;
+        individual.fitness = 0;
+        individual.rank = 0;
+        individual.crowding = 0;
+    }
+}
+
+// Copy constructor: copies the arena and rebases every view onto the new buffer
+// Time Complexity: O(P * S * C)
+// Space Complexity: O(P * S * C)
+Population::Population(const Population& other)
+{
+    *this = other;
+}
+
+// Copy assignment: same as the copy constructor
+// Time Complexity: O(P * S * C)
+// Space Complexity: O(P * S * C)
+Population& Population::operator=(const Population& other)
+{
+    if (this == &other) {
+        return *this;
+    }
+    this->numServers = other.numServers;
+    this->numClients = other.numClients;
+    this->numGenes = other.numGenes;
+    this->arena = other.arena;
+    this->loadArena = other.loadArena;
+    this->individuals = other.individuals;
+
+    // Views may have been permuted (e.g. by sorting), so keep each one's offsets
+    for (size_t k = 0; k < this->individuals.size(); k++) {
+        ptrdiff_t offset = other.individuals[k].ServerAllocations - other.arena.data();
+        ptrdiff_t loadOffset = other.individuals[k].serverLoads - other.loadArena.data();
+        this->individuals[k].ServerAllocations = this->arena.data() + offset;
+        this->individuals[k].serverLoads = this->loadArena.data() + loadOffset;
+        this->individuals[k].clientLoads = this->individuals[k].serverLoads + this->numServers;
+    }
+    return *this;
+}
+
+// Individual accessor
+// Time Complexity: O(1)
+// Space Complexity: O(1)
+Chromosome& Population::operator[](size_t index)
+{
+    return individuals[index];
+}
+
+// Read-only individual accessor
+// Time Complexity: O(1)
+// Space Complexity: O(1)
+const Chromosome& Population::operator[](size_t index) const
+{
+    return individuals[index];
+}
+
+// Number of individuals in the population
+// Time Complexity: O(1)
+// Space Complexity: O(1)
+size_t Population::size() const
+{
+    return individuals.size();
+}
+
+#endif
@@ -0,0 +1,230 @@
+// Scripted round trip through the solver daemon (see SolverDaemon.h)
+// Starts a daemon on a thread of this process, then solves instances with more servers than clients,
+// fewer servers than clients and as many of both over the socket, followed by a delta on each of them.
+// Every cold solve must return the same genes and fitness as geneticAlgorithm() run locally with the same
+// seed, and every result, deltas included, must carry the feasible flag that checkDaemonSolution()
+// computes from the returned genes and the bounds this side sent. Build and run:
+//   g++ -std=c++17 -O2 -pthread DaemonCheck.cpp -o DaemonCheck && ./DaemonCheck
+// Exits with 1 at the first failure, after printing it, and with 0 when every round trip matches.
+//
+// Constants and Macros:
+// - CHECK_GENERATIONS, CHECK_POPULATION: Settings of every solve.
+
+#include "SolverDaemon.h"
+#include <iostream>
+#include <thread>
+
+#define CHECK_GENERATIONS 150
+#define CHECK_POPULATION 40
+
+using namespace std;
+
+#ifndef _WIN32
+
+// One instance of the script and the bounds the daemon was last told about
+struct CheckInstance
+{
+    unsigned int numServers;
+    unsigned int numClients;
+    vector<double> latencies; // Row-major S x C
+    vector<uint32_t> bandwidths;
+    vector<uint32_t> capacities;
+};
+
+// Random instance whose capacities and bandwidths leave room for a feasible assignment
+// Time Complexity: O(S * C)
+// Space Complexity: O(S * C)
+CheckInstance makeCheckInstance(unsigned int numServers, unsigned int numClients, Rng& rng)
+{
+    CheckInstance instance;
+    instance.numServers = numServers;
+    instance.numClients = numClients;
+    for (size_t k = 0; k < (size_t)numServers * numClients; k++) {
+        instance.latencies.push_back(1.0 + 49.0 * rng.uniform());
+    }
+    for (unsigned int j = 0; j < numClients; j++) {
+        instance.bandwidths.push_back(20 + rng.bounded(40));
+    }
+    for (unsigned int i = 0; i < numServers; i++) {
+        instance.capacities.push_back(10 * numClients + rng.bounded(20 * numClients));
+    }
+    return instance;
+}
+
+// Reads frames until a DAEMON_RESULT, whose header and genes are returned
+// Time Complexity: O(F * S * C), F stands for the frames received
+// Space Complexity: O(S * C)
+bool receiveCheckResult(int fd, vector<unsigned char>& payload, DaemonSolution& header, vector<double>& genes)
+{
+    DaemonFrame frame;
+    while (readFrame(fd, frame, payload)) {
+        if (frame.type == DAEMON_ERROR) {
+            cout << "FAIL daemon error: " << string(payload.begin(), payload.end()) << endl;
+            return false;
+        }
+        if (frame.type != DAEMON_RESULT) {
+            continue;
+        }
+        memcpy(&header, payload.data(), sizeof(header));
+        genes.resize((size_t)header.numServers * header.numClients);
+        if (payload.size() != sizeof(header) + genes.size() * sizeof(double)) {
+            cout << "FAIL truncated result frame" << endl;
+            return false;
+        }
+        memcpy(genes.data(), payload.data() + sizeof(header), genes.size() * sizeof(double));
+        return true;
+    }
+    cout << "FAIL connection closed by the daemon" << endl;
+    return false;
+}
+
+// Checks the feasible flag of a result against the genes and the bounds of instance
+// Time Complexity: O(S * C)
+// Space Complexity: O(S + C)
+bool checkFeasibleFlag(const string& name, const CheckInstance& instance, const DaemonSolution& header, const vector<double>& genes)
+{
+    double worstExcess;
+    bool feasible = checkDaemonSolution(header, genes.data(), instance.bandwidths, instance.capacities, worstExcess);
+    if (header.numServers != instance.numServers || header.numClients != instance.numClients) {
+        cout << "FAIL " << name << ": result is " << header.numServers << " x " << header.numClients << endl;
+        return false;
+    }
+    if (feasible != (header.feasible != 0) && fabs(worstExcess) > DAEMON_CHECK_TOLERANCE) {
+        cout << "FAIL " << name << ": daemon says " << (header.feasible ? "feasible" : "infeasible") << ", the genes are "
+             << (feasible ? "feasible" : "infeasible") << " (worst relative excess " << worstExcess << ")" << endl;
+        return false;
+    }
+    cout << "  " << name << ": fitness " << header.fitness << (header.feasible ? ", feasible" : ", infeasible") << endl;
+    return true;
+}
+
+// Cold solve of instance over the socket, compared with a local solve of the same seed
+// Time Complexity: O(2 * G * P * S * C)
+// Space Complexity: O(P * S * C)
+bool checkSolve(int fd, const CheckInstance& instance, const GAConfig& config, ThreadPool& pool, vector<unsigned char>& buffer)
+{
+    string name = to_string(instance.numServers) + " x " + to_string(instance.numClients) + " solve";
+    DaemonSolveHeader header;
+    memset(&header, 0, sizeof(header));
+    header.numServers = instance.numServers;
+    header.numClients = instance.numClients;
+    header.options.seed = config.seed;
+    vector<unsigned char> payload(sizeof(header));
+    memcpy(payload.data(), &header, sizeof(header));
+    const unsigned char* latencies = (const unsigned char*)instance.latencies.data();
+    const unsigned char* bandwidths = (const unsigned char*)instance.bandwidths.data();
+    const unsigned char* capacities = (const unsigned char*)instance.capacities.data();
+    payload.insert(payload.end(), latencies, latencies + instance.latencies.size() * sizeof(double));
+    payload.insert(payload.end(), bandwidths, bandwidths + instance.bandwidths.size() * sizeof(uint32_t));
+    payload.insert(payload.end(), capacities, capacities + instance.capacities.size() * sizeof(uint32_t));
+    DaemonSolution result;
+    vector<double> genes;
+    if (!writeFrame(fd, DAEMON_SOLVE, payload.data(), payload.size(), nullptr, 0, buffer)
+        || !receiveCheckResult(fd, buffer, result, genes) || !checkFeasibleFlag(name, instance, result, genes)) {
+        return false;
+    }
+
+    vector<vector<double>> matrix(instance.numServers, vector<double>(instance.numClients));
+    for (unsigned int i = 0; i < instance.numServers; i++) {
+        for (unsigned int j = 0; j < instance.numClients; j++) {
+            matrix[i][j] = instance.latencies[(size_t)i * instance.numClients + j];
+        }
+    }
+    Task task(instance.numServers, instance.numClients, matrix);
+    for (unsigned int i = 0; i < instance.numServers; i++) {
+        task.setCapacity(i, instance.capacities[i]);
+    }
+    for (unsigned int j = 0; j < instance.numClients; j++) {
+        task.setBandwith(j, instance.bandwidths[j]);
+    }
+    GAConfig local = config;
+    BestSolution best;
+    local.bestSolution = &best;
+    geneticAlgorithm(task, local, pool);
+    SolutionSnapshot expected = best.snapshot();
+    if (expected.fitness != result.fitness || expected.isFeas != (result.feasible != 0)
+        || !equal(expected.genes.begin(), expected.genes.end(), genes.begin())) {
+        cout << "FAIL " << name << ": local solve found fitness " << expected.fitness << (expected.isFeas ? ", feasible" : ", infeasible")
+             << ", the daemon " << result.fitness << (result.feasible ? ", feasible" : ", infeasible") << endl;
+        return false;
+    }
+    return true;
+}
+
+// Halves the capacity of server 0 and the bandwidth of the last client, sends it as a delta and checks
+// the warm re-solve against the new bounds
+// Time Complexity: O(G * P * S * C)
+// Space Complexity: O(S * C)
+bool checkDelta(int fd, CheckInstance& instance, vector<unsigned char>& buffer)
+{
+    string name = to_string(instance.numServers) + " x " + to_string(instance.numClients) + " delta";
+    unsigned int lastClient = instance.numClients - 1;
+    instance.capacities[0] /= 2;
+    instance.bandwidths[lastClient] /= 2;
+    DaemonDeltaHeader header;
+    memset(&header, 0, sizeof(header));
+    header.numBandwidths = 1;
+    header.numCapacities = 1;
+    uint32_t pairs[4] = {lastClient, instance.bandwidths[lastClient], 0, instance.capacities[0]};
+    DaemonSolution result;
+    vector<double> genes;
+    return writeFrame(fd, DAEMON_DELTA, &header, sizeof(header), pairs, sizeof(pairs), buffer)
+           && receiveCheckResult(fd, buffer, result, genes) && checkFeasibleFlag(name, instance, result, genes);
+}
+
+int main()
+{
+    GAConfig config;
+    config.seed = 7;
+    config.generations = CHECK_GENERATIONS;
+    config.populationSize = CHECK_POPULATION;
+    config.verbose = false;
+    config.printBest = false;
+
+    string path = "/tmp/DaemonCheck." + to_string(getpid()) + ".sock";
+    SolverDaemon daemon(config);
+    if (!daemon.listen(path)) {
+        return 1;
+    }
+    thread server([&daemon]() { daemon.serve(); });
+
+    // More servers than clients (the case capacities used to be dropped for), fewer, and as many
+    Rng rng(2024);
+    vector<CheckInstance> instances;
+    instances.push_back(makeCheckInstance(6, 3, rng));
+    instances.push_back(makeCheckInstance(12, 5, rng));
+    instances.push_back(makeCheckInstance(4, 10, rng));
+    instances.push_back(makeCheckInstance(7, 7, rng));
+
+    ThreadPool pool(1);
+    vector<unsigned char> buffer;
+    bool ok = true;
+    for (size_t k = 0; k < instances.size() && ok; k++) {
+        int fd = connectDaemon(path);
+        ok = fd >= 0 && checkSolve(fd, instances[k], config, pool, buffer) && checkDelta(fd, instances[k], buffer);
+        if (fd >= 0) {
+            close(fd);
+        }
+    }
+
+    int fd = connectDaemon(path);
+    if (fd >= 0) {
+        writeFrame(fd, DAEMON_SHUTDOWN, nullptr, 0, nullptr, 0, buffer);
+        close(fd);
+    }
+    server.join();
+    if (ok) {
+        cout << instances.size() << " solves and deltas match" << endl;
+    }
+    return ok ? 0 : 1;
+}
+
+#else
+
+int main()
+{
+    cout << "The solver daemon needs Unix domain sockets" << endl;
+    return 1;
+}
+
+#endif
@@ -0,0 +1,591 @@
+#ifndef DECOMPOSITION_H
+#define DECOMPOSITION_H
+
+// Hierarchical decomposition for very large instances
+// A single GA costs O(P * S * C) per generation over the whole matrix. The decomposition instead:
+// 1. Clusters the clients by latency similarity: k-means (k-means++ seeding) on the share of its
+//    ideal allocation each server gets, i.e. the inverse latencies of a client normalized to sum to 1.
+// 2. Gives every server to the cluster whose clients want the most of it (sum of their ideal allocations).
+// 3. Solves one subproblem per cluster, its servers x its clients, in parallel with solveBatch().
+// 4. Coordinates the clusters: the solutions are assembled into one assignment of the full task, the
+//    pairs between clusters start at their smallest gene (minimumGene()), the capacity every server has
+//    left after its own cluster goes to these pairs, clients with the largest objective weight first,
+//    and repairIndividual() brings anything still over a capacity or bandwidth back within it.
+// A subproblem keeps the ideal allocations of the full task: the bandwidth of a client in it is its ideal
+// share of the cluster's servers. Capacities and bandwidths are reduced by the smallest genes reserved for
+// the pairs between clusters, so the assembled assignment only needs the coordination to fill them up.
+//
+// With K clusters a subproblem has about E / K^2 genes (E = S * C, or the reachable pairs if sparse), so
+// a generation of all of them costs O(P * E / K). K is picked so a subproblem has about
+// DECOMPOSE_CLUSTER_GENES genes, the GA work then grows as the square root of E. The clustering costs
+// O(E * K) per k-means iteration and the coordination O(E + C log C).
+//
+// The settings and stopping criteria of GAConfig apply to every subproblem, numThreads is the number of
+// subproblems solved at once. A time budget covers the whole run: what is left after the clustering is
+// shared out between the rounds of subproblems. The multi-objective mode is not supported.
+//
+// Constants and Macros:
+// - DECOMPOSE_CLUSTERS: Number of clusters (0 -> sized by DECOMPOSE_CLUSTER_GENES).
+// - DECOMPOSE_CLUSTER_GENES: Genes per subproblem the automatic number of clusters aims for.
+// - DECOMPOSE_ITERATIONS: Most k-means iterations, the clustering stops earlier once no client moves.
+
+#include "BatchSolver.h"
+#include <chrono>
+#include <cmath>
+#include <numeric>
+#include <vector>
+
+#define DECOMPOSE_CLUSTERS 0
+#define DECOMPOSE_CLUSTER_GENES (1u << 14)
+#define DECOMPOSE_ITERATIONS 20
+
+using namespace std;
+
+// Settings of a decomposition run, the defaults come from the macros above
+struct DecompositionConfig
+{
+    unsigned int numClusters = DECOMPOSE_CLUSTERS; // 0 -> automatic
+    unsigned int clusterGenes = DECOMPOSE_CLUSTER_GENES;
+    unsigned int iterations = DECOMPOSE_ITERATIONS;
+};
+
+// Number of clusters of the current task: config.numClusters, or about sqrt(E / clusterGenes), at most
+// the number of servers and of clients since every cluster needs one of each
+// Time Complexity: O(1)
+// Space Complexity: O(1)
+unsigned int decompositionClusters(const DecompositionConfig& config)
+{
+    Task& task = activeSolve->task;
+    unsigned int clusters = config.numClusters;
+    if (clusters == 0) {
+        clusters = (unsigned int)round(sqrt((double)task.getNumGenes() / max(1u, config.clusterGenes)));
+    }
+    return max(1u, min(clusters, min(task.getNumServers(), task.getNumClients())));
+}
+
+// Dot products of every client's share vector with count centroids of S values each
+// dots[j * count + c] receives the product of client j with centroid c.
+// Time Complexity: O(E * K), K stands for count
+// Space Complexity: O(1)
+void centroidDots(const double* centroids, unsigned int count, vector<double>& dots)
+{
+    Task& task = activeSolve->task;
+    GeneLayout layout = geneLayout();
+    const double* inverse = task.getInverseLatencyTable();
+    const double* totals = task.getLatencyTotals();
+    unsigned int numServers = task.getNumServers();
+    dots.assign((size_t)task.getNumClients() * count, 0.0);
+    for (unsigned int i = 0; i < numServers; i++) {
+        for (unsigned int k = layout.edgeStart[i]; k < layout.edgeStart[i + 1]; k++) {
+            unsigned int client = layout.client(i, k);
+            double share = inverse[k] / totals[client];
+            for (unsigned int c = 0; c < count; c++) {
+                dots[(size_t)client * count + c] += share * centroids[(size_t)c * numServers + i];
+            }
+        }
+    }
+}
+
+// Centroid of one client: its share vector written into S values
+// Time Complexity: O(E)
+// Space Complexity: O(1)
+void clientShares(unsigned int client, double* centroid)
+{
+    Task& task = activeSolve->task;
+    GeneLayout layout = geneLayout();
+    const double* inverse = task.getInverseLatencyTable();
+    const double* totals = task.getLatencyTotals();
+    for (unsigned int i = 0; i < task.getNumServers(); i++) {
+        centroid[i] = 0;
+        for (unsigned int k = layout.edgeStart[i]; k < layout.edgeStart[i + 1]; k++) {
+            if (layout.client(i, k) == client) {
+                centroid[i] = inverse[k] / totals[client];
+                break;
+            }
+        }
+    }
+}
+
+// k-means of the clients on their share vectors, the first centroids are drawn by k-means++
+// clientCluster receives a cluster in [0, clusters) for every client, some clusters may end up empty.
+// Time Complexity: O(I * E * K), I stands for iterations
+// Space Complexity: O(S * K + C * K)
+void clusterClients(unsigned int clusters, unsigned int iterations, Rng& rng, vector<unsigned int>& clientCluster)
+{
+    Task& task = activeSolve->task;
+    GeneLayout layout = geneLayout();
+    const double* inverse = task.getInverseLatencyTable();
+    const double* totals = task.getLatencyTotals();
+    unsigned int numServers = task.getNumServers();
+    unsigned int numClients = task.getNumClients();
+
+    vector<double> norms(numClients, 0.0); // Squared norm of each share vector
+    for (unsigned int i = 0; i < numServers; i++) {
+        for (unsigned int k = layout.edgeStart[i]; k < layout.edgeStart[i + 1]; k++) {
+            unsigned int client = layout.client(i, k);
+            double share = inverse[k] / totals[client];
+            norms[client] += share * share;
+        }
+    }
+
+    // k-means++: each next centroid is a client drawn with probability proportional to its squared
+    // distance to the nearest centroid so far
+    vector<double> centroids((size_t)clusters * numServers, 0.0);
+    vector<double> centroidNorms(clusters, 0.0);
+    vector<double> nearest(numClients, INFINITY);
+    vector<double> dots;
+    unsigned int center = rng.bounded(numClients);
+    for (unsigned int c = 0; c < clusters; c++) {
+        if (c > 0) {
+            double total = accumulate(nearest.begin(), nearest.end(), 0.0);
+            double target = rng.uniform() * total;
+            center = rng.bounded(numClients); // Every client sits on a centroid already, any one will do
+            for (unsigned int j = 0; j < numClients && total > 0; j++) {
+                target -= nearest[j];
+                if (target < 0) {
+                    center = j;
+                    break;
+                }
+            }
+        }
+        clientShares(center, &centroids[(size_t)c * numServers]);
+        centroidNorms[c] = norms[center];
+        centroidDots(&centroids[(size_t)c * numServers], 1, dots);
+        for (unsigned int j = 0; j < numClients; j++) {
+            nearest[j] = min(nearest[j], max(norms[j] - 2 * dots[j] + centroidNorms[c], 0.0));
+        }
+    }
+
+    // Lloyd iterations, ||s - m||^2 = ||s||^2 - 2 s.m + ||m||^2 and ||s||^2 does not depend on the cluster
+    clientCluster.assign(numClients, clusters);
+    vector<unsigned int> counts(clusters);
+    for (unsigned int iteration = 0; iteration < max(1u, iterations); iteration++) {
+        centroidDots(centroids.data(), clusters, dots);
+        unsigned int moved = 0;
+        for (unsigned int j = 0; j < numClients; j++) {
+            unsigned int best = 0;
+            double bestDistance = INFINITY;
+            for (unsigned int c = 0; c < clusters; c++) {
+                double distance = centroidNorms[c] - 2 * dots[(size_t)j * clusters + c];
+                if (distance < bestDistance) {
+                    best = c;
+                    bestDistance = distance;
+                }
+            }
+            moved += best != clientCluster[j];
+            clientCluster[j] = best;
+        }
+        if (moved == 0) {
+            break;
+        }
+
+        fill(centroids.begin(), centroids.end(), 0.0);
+        fill(counts.begin(), counts.end(), 0);
+        for (unsigned int j = 0; j < numClients; j++) {
+            counts[clientCluster[j]]++;
+        }
+        for (unsigned int i = 0; i < numServers; i++) {
+            for (unsigned int k = layout.edgeStart[i]; k < layout.edgeStart[i + 1]; k++) {
+                unsigned int client = layout.client(i, k);
+                centroids[(size_t)clientCluster[client] * numServers + i] += inverse[k] / totals[client];
+            }
+        }
+        for (unsigned int c = 0; c < clusters; c++) {
+            double norm = 0;
+            for (unsigned int i = 0; i < numServers; i++) {
+                double& value = centroids[(size_t)c * numServers + i];
+                value /= max(1u, counts[c]);
+                norm += value * value;
+            }
+            centroidNorms[c] = counts[c] ? norm : INFINITY; // An empty cluster attracts no client
+        }
+    }
+}
+
+// Gives every server to the cluster with clients whose ideal allocations on it add up the most
+// A cluster with clients but no server then takes the server it wants most from a cluster that has
+// several, so every cluster with clients has a server (there are at most S clusters).
+// Time Complexity: O(E + S * K)
+// Space Complexity: O(S * K)
+void assignServers(unsigned int clusters, const vector<unsigned int>& clientCluster, vector<unsigned int>& serverCluster)
+{
+    Task& task = activeSolve->task;
+    GeneLayout layout = geneLayout();
+    const double* ideal = task.getIdealAllocations();
+    unsigned int numServers = task.getNumServers();
+
+    vector<double> load((size_t)numServers * clusters, 0.0);
+    vector<unsigned int> clientsIn(clusters, 0);
+    vector<unsigned int> serversIn(clusters, 0);
+    for (unsigned int cluster : clientCluster) {
+        clientsIn[cluster]++;
+    }
+    for (unsigned int i = 0; i < numServers; i++) {
+        for (unsigned int k = layout.edgeStart[i]; k < layout.edgeStart[i + 1]; k++) {
+            load[(size_t)i * clusters + clientCluster[layout.client(i, k)]] += ideal[k];
+        }
+    }
+    serverCluster.assign(numServers, 0);
+    for (unsigned int i = 0; i < numServers; i++) {
+        double bestLoad = -1;
+        for (unsigned int c = 0; c < clusters; c++) {
+            if (clientsIn[c] && load[(size_t)i * clusters + c] > bestLoad) {
+                serverCluster[i] = c;
+                bestLoad = load[(size_t)i * clusters + c];
+            }
+        }
+        serversIn[serverCluster[i]]++;
+    }
+    for (unsigned int c = 0; c < clusters; c++) {
+        if (clientsIn[c] == 0 || serversIn[c] > 0) {
+            continue;
+        }
+        unsigned int donor = numServers;
+        for (unsigned int i = 0; i < numServers; i++) {
+            if (serversIn[serverCluster[i]] > 1 && (donor == numServers || load[(size_t)i * clusters + c] > load[(size_t)donor * clusters + c])) {
+                donor = i;
+            }
+        }
+        serversIn[serverCluster[donor]]--;
+        serverCluster[donor] = c;
+        serversIn[c]++;
+    }
+}
+
+// Sparse tasks: a client that reaches no server of its cluster moves to the cluster of its nearest
+// server, then the servers of clusters left without clients are given out again.
+// Time Complexity: O(E + S * K)
+// Space Complexity: O(S * K + C)
+void reachClusters(unsigned int clusters, vector<unsigned int>& clientCluster, vector<unsigned int>& serverCluster)
+{
+    Task& task = activeSolve->task;
+    GeneLayout layout = geneLayout();
+    const double* inverse = task.getInverseLatencyTable();
+    unsigned int numServers = task.getNumServers();
+    unsigned int numClients = task.getNumClients();
+
+    vector<bool> reached(numClients, false);
+    vector<double> nearestInverse(numClients, -1.0);
+    vector<unsigned int> nearestServer(numClients, 0);
+    for (unsigned int i = 0; i < numServers; i++) {
+        for (unsigned int k = layout.edgeStart[i]; k < layout.edgeStart[i + 1]; k++) {
+            unsigned int client = layout.client(i, k);
+            reached[client] = reached[client] || serverCluster[i] == clientCluster[client];
+            if (inverse[k] > nearestInverse[client]) {
+                nearestInverse[client] = inverse[k];
+                nearestServer[client] = i;
+            }
+        }
+    }
+    unsigned int moved = 0;
+    for (unsigned int j = 0; j < numClients; j++) {
+        if (!reached[j] && nearestInverse[j] >= 0) {
+            clientCluster[j] = serverCluster[nearestServer[j]];
+            moved++;
+        }
+    }
+    if (moved == 0) {
+        return;
+    }
+
+    vector<unsigned int> clientsIn(clusters, 0);
+    for (unsigned int cluster : clientCluster) {
+        clientsIn[cluster]++;
+    }
+    vector<double> load(clusters);
+    for (unsigned int i = 0; i < numServers; i++) {
+        if (clientsIn[serverCluster[i]]) {
+            continue;
+        }
+        fill(load.begin(), load.end(), 0.0);
+        for (unsigned int k = layout.edgeStart[i]; k < layout.edgeStart[i + 1]; k++) {
+            load[clientCluster[layout.client(i, k)]] += inverse[k];
+        }
+        double bestLoad = -1;
+        for (unsigned int c = 0; c < clusters; c++) {
+            if (clientsIn[c] && load[c] > bestLoad) {
+                serverCluster[i] = c;
+                bestLoad = load[c];
+            }
+        }
+    }
+}
+
+// Renumbers the clusters that have clients as 0, 1, ... and returns how many there are
+// Time Complexity: O(S + C + K)
+// Space Complexity: O(K)
+unsigned int compactClusters(unsigned int clusters, vector<unsigned int>& clientCluster, vector<unsigned int>& serverCluster)
+{
+    vector<unsigned int> index(clusters, clusters);
+    unsigned int used = 0;
+    for (unsigned int& cluster : clientCluster) {
+        if (index[cluster] == clusters) {
+            index[cluster] = used++;
+        }
+        cluster = index[cluster];
+    }
+    for (unsigned int& cluster : serverCluster) {
+        cluster = index[cluster];
+    }
+    return used;
+}
+
+// Builds the subproblem of every cluster
+// jobs[c] receives the task of cluster c: its servers x its clients, same latencies, capacities and
+// bandwidths reduced by the smallest genes of the pairs between clusters, bandwidths capped at the
+// clients' ideal share of the cluster. geneMaps[c][m] is the gene of the full task behind gene m of it.
+// Time Complexity: O(E) dense, O(E log C) sparse (latency lookups)
+// Space Complexity: O(E)
+void buildSubproblems(unsigned int clusters, const vector<unsigned int>& clientCluster, const vector<unsigned int>& serverCluster,
+                      vector<BatchJob>& jobs, vector<vector<unsigned int>>& geneMaps)
+{
+    Task& task = activeSolve->task;
+    GeneLayout layout = geneLayout();
+    const double* ideal = task.getIdealAllocations();
+    unsigned int numServers = task.getNumServers();
+    unsigned int numClients = task.getNumClients();
+
+    vector<double> serverReserve(numServers, 0.0);
+    vector<double> clientReserve(numClients, 0.0);
+    vector<double> clusterIdeal(numClients, 0.0); // Ideal allocations of a client on the servers of its cluster
+    for (unsigned int i = 0; i < numServers; i++) {
+        for (unsigned int k = layout.edgeStart[i]; k < layout.edgeStart[i + 1]; k++) {
+            unsigned int client = layout.client(i, k);
+            if (serverCluster[i] == clientCluster[client]) {
+                clusterIdeal[client] += ideal[k];
+            } else {
+                double reserve = minimumGene(ideal[k]);
+                serverReserve[i] += reserve;
+                clientReserve[client] += reserve;
+            }
+        }
+    }
+
+    // Local numbering, in increasing order of the full task so sparse rows stay sorted
+    vector<vector<unsigned int>> servers(clusters);
+    vector<vector<unsigned int>> clients(clusters);
+    for (unsigned int j = 0; j < numClients; j++) {
+        clients[clientCluster[j]].push_back(j);
+    }
+    vector<unsigned int> clientLocal(numClients);
+    for (unsigned int c = 0; c < clusters; c++) {
+        for (unsigned int b = 0; b < clients[c].size(); b++) {
+            clientLocal[clients[c][b]] = b;
+        }
+    }
+    for (unsigned int i = 0; i < numServers; i++) {
+        servers[serverCluster[i]].push_back(i);
+    }
+
+    jobs.assign(clusters, BatchJob());
+    geneMaps.assign(clusters, vector<unsigned int>());
+    for (unsigned int c = 0; c < clusters; c++) {
+        unsigned int subServers = servers[c].size();
+        unsigned int subClients = clients[c].size();
+        vector<vector<double>> matrix;
+        vector<unsigned int> edgeStart(1, 0);
+        vector<unsigned int> edgeClients;
+        vector<double> latencies;
+        if (!task.isSparse()) {
+            matrix.assign(subServers, vector<double>(subClients));
+        }
+        for (unsigned int a = 0; a < subServers; a++) {
+            unsigned int i = servers[c][a];
+            for (unsigned int k = layout.edgeStart[i]; k < layout.edgeStart[i + 1]; k++) {
+                unsigned int client = layout.client(i, k);
+                if (clientCluster[client] != c) {
+                    continue;
+                }
+                double latency = task.getLatency(i, client);
+                if (task.isSparse()) {
+                    edgeClients.push_back(clientLocal[client]);
+                    latencies.push_back(latency);
+                } else {
+                    matrix[a][clientLocal[client]] = latency;
+                }
+                geneMaps[c].push_back(k);
+            }
+            edgeStart.push_back(edgeClients.size());
+        }
+        Task& sub = jobs[c].task;
+        sub = task.isSparse() ? Task(subServers, subClients, edgeStart, edgeClients, latencies) : Task(subServers, subClients, matrix);
+        for (unsigned int a = 0; a < subServers; a++) {
+            unsigned int i = servers[c][a];
+            sub.setCapacity(a, (unsigned int)max(floor(task.getCapacity(i) - serverReserve[i]), 0.0));
+        }
+        for (unsigned int b = 0; b < subClients; b++) {
+            unsigned int j = clients[c][b];
+            double bandwidth = min(floor(task.getBandwith(j) - clientReserve[j]), round(clusterIdeal[j]));
+            sub.setBandwith(b, (unsigned int)max(bandwidth, 1.0));
+        }
+    }
+}
+
+// Coordination pass: hands the capacity servers have left after their own cluster to the pairs between
+// clusters. Clients are served in decreasing order of their latency total (the objective gained per unit
+// allocated below the ideal), each of their pairs to other clusters is raised towards its ideal allocation
+// while its server has capacity and its client bandwidth left. Returns the allocation added.
+// The cached loads are used as scratch, the next evaluation of the individual is a full one.
+// Time Complexity: O(E + C log C)
+// Space Complexity: O(E) for the pairs of each client
+double coordinateClusters(Chromosome& individual, const vector<unsigned int>& clientCluster, const vector<unsigned int>& serverCluster)
+{
+    Task& task = activeSolve->task;
+    GeneLayout layout = geneLayout();
+    const double* ideal = task.getIdealAllocations();
+    const double* totals = task.getLatencyTotals();
+    Gene* genes = individual.ServerAllocations;
+    double* serverLeft = individual.serverLoads;
+    double* clientLeft = individual.clientLoads;
+    unsigned int numServers = individual.numServers;
+    unsigned int numClients = individual.numClients;
+
+    // Pairs between clusters grouped by client (counting sort)
+    vector<unsigned int> pairStart(numClients + 1, 0);
+    fill(clientLeft, clientLeft + numClients, 0.0);
+    for (unsigned int i = 0; i < numServers; i++) {
+        serverLeft[i] = 0;
+        for (unsigned int k = layout.edgeStart[i]; k < layout.edgeStart[i + 1]; k++) {
+            unsigned int client = layout.client(i, k);
+            serverLeft[i] += genes[k];
+            clientLeft[client] += genes[k];
+            pairStart[client + 1] += serverCluster[i] != clientCluster[client];
+        }
+        serverLeft[i] = (1.0 - REPAIR_SLACK) * task.getCapacity(i) - serverLeft[i];
+    }
+    for (unsigned int j = 0; j < numClients; j++) {
+        clientLeft[j] = (1.0 - REPAIR_SLACK) * task.getBandwith(j) - clientLeft[j];
+        pairStart[j + 1] += pairStart[j];
+    }
+    vector<unsigned int> next(pairStart.begin(), pairStart.end() - 1);
+    vector<pair<unsigned int, unsigned int>> pairs(pairStart[numClients]); // (gene, server)
+    for (unsigned int i = 0; i < numServers; i++) {
+        for (unsigned int k = layout.edgeStart[i]; k < layout.edgeStart[i + 1]; k++) {
+            unsigned int client = layout.client(i, k);
+            if (serverCluster[i] != clientCluster[client]) {
+                pairs[next[client]++] = make_pair(k, i);
+            }
+        }
+    }
+
+    vector<unsigned int> order(numClients);
+    iota(order.begin(), order.end(), 0);
+    stable_sort(order.begin(), order.end(), [totals](unsigned int a, unsigned int b) {
+        return totals[a] > totals[b];
+    });
+    double added = 0;
+    for (unsigned int client : order) {
+        for (unsigned int p = pairStart[client]; p < pairStart[client + 1] && clientLeft[client] > 0; p++) {
+            unsigned int k = pairs[p].first;
+            unsigned int server = pairs[p].second;
+            double amount = min(min(ideal[k] - genes[k], clientLeft[client]), serverLeft[server]);
+            if (amount > 0) {
+                amount = raiseGene(genes[k], amount);
+                clientLeft[client] -= amount;
+                serverLeft[server] -= amount;
+                added += amount;
+            }
+        }
+    }
+    individual.cacheValid = false;
+    individual.modified = true;
+    return added;
+}
+
+// Decomposition solver: clusters, solves the clusters in parallel, coordinates them into one assignment
+// gaConfig: settings of every subproblem (see the top of this file), gaConfig.bestSolution receives the
+// assignment of the full task, gaConfig.printBest prints it.
+// Time Complexity: O(I * E * K + G * P * E / K / T + E log C), T = min(K, gaConfig.numThreads)
+// Space Complexity: O(E + T * P * E / K^2)
+void decomposedGeneticAlgorithm(Task task1, const GAConfig& gaConfig, DecompositionConfig config = DecompositionConfig())
+{
+    typedef chrono::steady_clock Clock;
+    Clock::time_point start = Clock::now();
+    if (gaConfig.multiObjective) {
+        cout << "The decomposition does not support the multi-objective mode, using the weighted fitness" << endl;
+    }
+    SolveContext context;
+    context.task = move(task1);
+    context.task.freeze();
+    SolveScope scope(context);
+    findUpperBound();
+    Task& task = context.task;
+
+    // Clusters of clients, then of servers
+    unsigned int clusters = decompositionClusters(config);
+    Rng rng = RandomStreams(gaConfig.seed).stream(PHASE_DECOMPOSITION, 0, 0);
+    vector<unsigned int> clientCluster;
+    vector<unsigned int> serverCluster;
+    clusterClients(clusters, config.iterations, rng, clientCluster);
+    assignServers(clusters, clientCluster, serverCluster);
+    if (task.isSparse()) {
+        reachClusters(clusters, clientCluster, serverCluster);
+    }
+    clusters = compactClusters(clusters, clientCluster, serverCluster);
+    vector<BatchJob> jobs;
+    vector<vector<unsigned int>> geneMaps;
+    buildSubproblems(clusters, clientCluster, serverCluster, jobs, geneMaps);
+    double clusteringSeconds = chrono::duration<double>(Clock::now() - start).count();
+    if (gaConfig.verbose) {
+        size_t largest = 0;
+        for (const BatchJob& job : jobs) {
+            largest = max<size_t>(largest, job.task.getNumGenes());
+        }
+        cout << "Seed = " << gaConfig.seed << ", Clusters = " << clusters << ", largest subproblem " << largest << " of "
+             << task.getNumGenes() << " genes, clustered in " << clusteringSeconds << " s" << endl;
+    }
+
+    // Subproblems, the time left is shared out between the rounds of the batch
+    unsigned int workers = gaConfig.numThreads ? gaConfig.numThreads : max(1u, thread::hardware_concurrency());
+    workers = min(workers, clusters);
+    if (gaConfig.timeBudget > 0) {
+        unsigned int rounds = (clusters + workers - 1) / workers;
+        for (BatchJob& job : jobs) {
+            job.timeBudget = max(gaConfig.timeBudget - clusteringSeconds, 1e-3) / rounds;
+        }
+    }
+    GAConfig subConfig = gaConfig;
+    subConfig.multiObjective = false;
+    vector<BatchResult> results = solveBatch(jobs, subConfig, workers);
+    Clock::time_point solved = Clock::now();
+
+    // Coordination on the assembled assignment of the full task
+    Population assembled(1, task.getNumServers(), task.getNumClients(), task.getNumGenes());
+    Chromosome& best = assembled[0];
+    const double* ideal = task.getIdealAllocations();
+    for (size_t k = 0; k < best.size(); k++) {
+        best.ServerAllocations[k] = minimumGene(ideal[k]);
+    }
+    for (unsigned int c = 0; c < clusters; c++) {
+        const vector<Gene>& genes = results[c].best.genes;
+        for (size_t m = 0; m < geneMaps[c].size() && m < genes.size(); m++) {
+            best.ServerAllocations[geneMaps[c][m]] = genes[m];
+        }
+    }
+    StaticPenalty penalty;
+    evaluateIndividual(best);
+    computeFitness(best, penalty);
+    double assembledFitness = best.fitness;
+    double added = coordinateClusters(best, clientCluster, serverCluster);
+    repairIndividual(best);
+    evaluateIndividual(best);
+    computeFitness(best, penalty);
+    double seconds = chrono::duration<double>(Clock::now() - start).count();
+    if (gaConfig.verbose) {
+        cout << "Subproblems solved in " << chrono::duration<double>(solved - start).count() - clusteringSeconds
+             << " s, coordination added " << added << " across clusters: fitness " << assembledFitness << " -> " << best.fitness
+             << " in " << chrono::duration<double>(Clock::now() - solved).count() << " s" << endl;
+        cout << "Decomposition finished in " << seconds << " s" << endl;
+    }
+
+    if (gaConfig.bestSolution && gaConfig.bestSolution->offer(best, gaConfig.generations, seconds) && gaConfig.onImprovement) {
+        gaConfig.onImprovement(*gaConfig.bestSolution);
+    }
+    if (gaConfig.printBest) {
+        cout << "Best: " << endl;
+        printIndividual(best);
+        cout << "Fitness = " << best.fitness << endl;
+    }
+}
+
+#endif
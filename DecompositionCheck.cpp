@@ -0,0 +1,135 @@
+// Checks the subproblems the decomposition builds (see Decomposition.h)
+// Clusters instances with two latency regions, one with many servers and few clients and one with few
+// servers and many clients, so some clusters have more servers than clients and others fewer. Every
+// subproblem must have the servers and clients of its cluster, each server the capacity of the full task
+// minus its reserve for the pairs to other clusters (clamped at 0) and each client a bandwidth within its
+// own, at least 1. The reserves are recomputed here from the clusters and minimumGene().
+// Build and run:
+//   g++ -std=c++17 -O2 -pthread DecompositionCheck.cpp -o DecompositionCheck && ./DecompositionCheck
+// Exits with 1 at the first mismatch, after printing it, and with 0 when every subproblem is right.
+
+#include "Decomposition.h"
+#include <iostream>
+
+using namespace std;
+
+SolveContext checkContext; // Instance being checked, bound to the main thread by main()
+
+// Two regions: servers [0, regionServers) are close to clients [0, regionClients), the others to the
+// other clients, every pair between the regions is far
+// Time Complexity: O(S * C)
+// Space Complexity: O(S * C)
+void setupRegions(unsigned int numServers, unsigned int numClients, unsigned int regionServers, unsigned int regionClients, Rng& rng)
+{
+    vector<vector<double>> latencies(numServers, vector<double>(numClients));
+    for (unsigned int i = 0; i < numServers; i++) {
+        for (unsigned int j = 0; j < numClients; j++) {
+            bool near = (i < regionServers) == (j < regionClients);
+            latencies[i][j] = near ? 1.0 + rng.uniform() : 50.0 + 50.0 * rng.uniform();
+        }
+    }
+    Task& task = checkContext.task;
+    task = Task(numServers, numClients, latencies);
+    for (unsigned int j = 0; j < numClients; j++) {
+        task.setBandwith(j, 50);
+    }
+    for (unsigned int i = 0; i < numServers; i++) {
+        task.setCapacity(i, 999);
+    }
+    task.freeze();
+    findUpperBound();
+}
+
+// Clusters the current task and checks the subproblem of every cluster
+// Time Complexity: O(I * E * K + E)
+// Space Complexity: O(E)
+bool checkSubproblems(unsigned int clusters, uint64_t seed, unsigned int& moreServers)
+{
+    Task& task = checkContext.task;
+    unsigned int numServers = task.getNumServers();
+    unsigned int numClients = task.getNumClients();
+    Rng rng(seed);
+    vector<unsigned int> clientCluster;
+    vector<unsigned int> serverCluster;
+    clusterClients(clusters, DECOMPOSE_ITERATIONS, rng, clientCluster);
+    assignServers(clusters, clientCluster, serverCluster);
+    clusters = compactClusters(clusters, clientCluster, serverCluster);
+    vector<BatchJob> jobs;
+    vector<vector<unsigned int>> geneMaps;
+    buildSubproblems(clusters, clientCluster, serverCluster, jobs, geneMaps);
+
+    const double* ideal = task.getIdealAllocations();
+    vector<double> serverReserve(numServers, 0.0);
+    for (unsigned int i = 0; i < numServers; i++) {
+        for (unsigned int j = 0; j < numClients; j++) {
+            if (serverCluster[i] != clientCluster[j]) {
+                serverReserve[i] += minimumGene(ideal[(size_t)i * numClients + j]);
+            }
+        }
+    }
+
+    string instance = to_string(numServers) + " x " + to_string(numClients);
+    for (unsigned int c = 0; c < clusters; c++) {
+        Task& sub = jobs[c].task;
+        vector<unsigned int> servers, clients;
+        for (unsigned int i = 0; i < numServers; i++) {
+            if (serverCluster[i] == c) {
+                servers.push_back(i);
+            }
+        }
+        for (unsigned int j = 0; j < numClients; j++) {
+            if (clientCluster[j] == c) {
+                clients.push_back(j);
+            }
+        }
+        if ((size_t)sub.getNumServers() != servers.size() || (size_t)sub.getNumClients() != clients.size()) {
+            cout << "FAIL " << instance << " cluster " << c << ": subproblem is " << sub.getNumServers() << " x " << sub.getNumClients()
+                 << ", the cluster " << servers.size() << " x " << clients.size() << endl;
+            return false;
+        }
+        moreServers += servers.size() > clients.size();
+        for (unsigned int a = 0; a < servers.size(); a++) {
+            unsigned int i = servers[a];
+            unsigned int expected = (unsigned int)max(floor(task.getCapacity(i) - serverReserve[i]), 0.0);
+            if (sub.getCapacity(a) != expected) {
+                cout << "FAIL " << instance << " cluster " << c << " (" << servers.size() << " x " << clients.size() << "): server " << i
+                     << " has capacity " << sub.getCapacity(a) << ", expected " << task.getCapacity(i) << " - reserve "
+                     << serverReserve[i] << " = " << expected << endl;
+                return false;
+            }
+        }
+        for (unsigned int b = 0; b < clients.size(); b++) {
+            unsigned int j = clients[b];
+            if (sub.getBandwith(b) < 1 || sub.getBandwith(b) > max(1u, task.getBandwith(j))) {
+                cout << "FAIL " << instance << " cluster " << c << ": client " << j << " has bandwidth " << sub.getBandwith(b)
+                     << ", its own is " << task.getBandwith(j) << endl;
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+int main()
+{
+    // Servers x clients, then the size of the first region
+    unsigned int instances[][4] = {{40, 60, 30, 4}, {60, 40, 50, 10}, {20, 20, 15, 3}, {10, 80, 2, 70}};
+    SolveScope scope(checkContext);
+    Rng rng(2024);
+    unsigned int checked = 0, moreServers = 0;
+    for (auto& instance : instances) {
+        setupRegions(instance[0], instance[1], instance[2], instance[3], rng);
+        for (uint64_t seed = 1; seed <= 3; seed++) {
+            if (!checkSubproblems(2, seed, moreServers)) {
+                return 1;
+            }
+            checked++;
+        }
+    }
+    if (moreServers == 0) {
+        cout << "FAIL no cluster had more servers than clients, the check does not cover that case" << endl;
+        return 1;
+    }
+    cout << checked << " decompositions checked, " << moreServers << " subproblems with more servers than clients" << endl;
+    return 0;
+}
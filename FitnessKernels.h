@@ -0,0 +1,322 @@
+#ifndef FITNESSKERNELS_H
+#define FITNESSKERNELS_H
+
+// Fitness kernels
+// One pass over a row-major S x C chromosome computes everything the evaluation needs:
+// - the latency score: sum of latencyTotal[client] * |ideal[server][client] - gene|
+// - the row sums (load of each server, checked against its capacity)
+// - the column sums (allocation of each client, checked against its bandwidth)
+// - the number of zero genes (connection penalty)
+// There is a scalar reference kernel and AVX2 / AVX-512 versions, the best one supported by
+// the CPU is picked once at startup. Vector kernels add in a different order than the scalar
+// one, so results may differ from it by rounding only.
+// Sparse tasks store only the reachable pairs and go through fitnessKernelSparse() instead.
+// Genes of any GENE_TYPE are widened to double as they are loaded, every sum is kept in double.
+//
+// Constants and Macros:
+// - KERNEL_METHOD: 0 -> best supported at runtime, 1 -> scalar, 2 -> AVX2, 3 -> AVX-512.
+
+#include "Chromosome.h"
+#include <cstdint>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define FITNESS_KERNELS_X86 1
+#include <immintrin.h>
+#endif
+
+#ifndef KERNEL_METHOD
+#define KERNEL_METHOD 0 // 0 -> auto, 1 -> scalar, 2 -> AVX2, 3 -> AVX-512
+#endif
+
+using namespace std;
+
+// Signature shared by every kernel.
+// rowSums must hold numServers values and colSums numClients values, both are overwritten.
+typedef void (*FitnessKernel)(const Gene* genes, const double* ideal, const double* latencyTotals,
+                              unsigned int numServers, unsigned int numClients,
+                              double* rowSums, double* colSums, double* latencyScore, unsigned int* zeroCount);
+
+// Scalar reference kernel, branch free so the compiler may still auto-vectorize it
+// Time Complexity: O(S * C)
+// Space Complexity: O(1)
+void fitnessKernelScalar(const Gene* genes, const double* ideal, const double* latencyTotals,
+                         unsigned int numServers, unsigned int numClients,
+                         double* rowSums, double* colSums, double* latencyScore, unsigned int* zeroCount)
+{
+    double score = 0.0;
+    unsigned int zeros = 0;
+    for (unsigned int i = 0; i < numClients; i++) {
+        colSums[i] = 0.0;
+    }
+
+    for (unsigned int j = 0; j < numServers; j++) {
+        const Gene* row = genes + (size_t)j * numClients;
+        const double* idealRow = ideal + (size_t)j * numClients;
+        double rowSum = 0.0;
+        for (unsigned int i = 0; i < numClients; i++) {
+            double x = row[i];
+            double diff = idealRow[i] - x;
+            score += latencyTotals[i] * (diff < 0 ? -diff : diff);
+            rowSum += x;
+            colSums[i] += x;
+            zeros += (x == 0);
+        }
+        rowSums[j] = rowSum;
+    }
+
+    *latencyScore = score;
+    *zeroCount = zeros;
+}
+
+// Kernel for sparse tasks: genes, ideal and the CSR lists hold one entry per reachable pair.
+// Unreachable pairs have no gene, so they add nothing to the score, the sums or the zero count.
+// Time Complexity: O(S + C + E), E stands for the number of reachable pairs
+// Space Complexity: O(1)
+void fitnessKernelSparse(const Gene* genes, const double* ideal, const double* latencyTotals,
+                         unsigned int numServers, unsigned int numClients,
+                         const unsigned int* edgeStart, const unsigned int* edgeClients,
+                         double* rowSums, double* colSums, double* latencyScore, unsigned int* zeroCount)
+{
+    double score = 0.0;
+    unsigned int zeros = 0;
+    for (unsigned int i = 0; i < numClients; i++) {
+        colSums[i] = 0.0;
+    }
+
+    for (unsigned int j = 0; j < numServers; j++) {
+        double rowSum = 0.0;
+        for (unsigned int k = edgeStart[j]; k < edgeStart[j + 1]; k++) {
+            unsigned int client = edgeClients[k];
+            double x = genes[k];
+            double diff = ideal[k] - x;
+            score += latencyTotals[client] * (diff < 0 ? -diff : diff);
+            rowSum += x;
+            colSums[client] += x;
+            zeros += (x == 0);
+        }
+        rowSums[j] = rowSum;
+    }
+
+    *latencyScore = score;
+    *zeroCount = zeros;
+}
+
+#ifdef FITNESS_KERNELS_X86
+
+// Loads 4 genes widened to double
+// Time Complexity: O(1)
+// Space Complexity: O(1)
+__attribute__((target("avx2")))
+__m256d loadGenes4(const Gene* genes)
+{
+#if GENE_TYPE == 1
+    return _mm256_cvtps_pd(_mm_loadu_ps(genes));
+#elif GENE_TYPE == 2
+    return _mm256_cvtepi32_pd(_mm_loadu_si128((const __m128i*)genes)); // Genes stay below 2^31
+#elif GENE_TYPE == 3
+    return _mm256_cvtepi32_pd(_mm_cvtepu16_epi32(_mm_loadl_epi64((const __m128i*)genes)));
+#else
+    return _mm256_loadu_pd(genes);
+#endif
+}
+
+// Loads 8 genes widened to double
+// The conversions are zero-masked ones, the unmasked forms trip -Wuninitialized in GCC 12 headers.
+// Time Complexity: O(1)
+// Space Complexity: O(1)
+__attribute__((target("avx512f")))
+__m512d loadGenes8(const Gene* genes)
+{
+#if GENE_TYPE == 1
+    return _mm512_maskz_cvtps_pd(0xFF, _mm256_loadu_ps(genes));
+#elif GENE_TYPE == 2
+    return _mm512_maskz_cvtepi32_pd(0xFF, _mm256_loadu_si256((const __m256i*)genes));
+#elif GENE_TYPE == 3
+    return _mm512_maskz_cvtepi32_pd(0xFF, _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i*)genes)));
+#else
+    return _mm512_loadu_pd(genes);
+#endif
+}
+
+// Loads the genes of the lanes set in mask (the first count lanes) widened to double, the others are 0
+// Narrow genes go through a zeroed buffer, masked loads of them would need AVX-512VL/BW.
+// Time Complexity: O(1)
+// Space Complexity: O(1)
+__attribute__((target("avx512f")))
+__m512d maskLoadGenes8(__mmask8 mask, const Gene* genes, unsigned int count)
+{
+#if GENE_TYPE == 0
+    (void)count;
+    return _mm512_maskz_loadu_pd(mask, genes);
+#else
+    (void)mask;
+    Gene lanes[8] = {};
+    memcpy(lanes, genes, count * sizeof(Gene));
+    return loadGenes8(lanes);
+#endif
+}
+
+// Sum of the 4 lanes, added pairwise
+// Time Complexity: O(1)
+// Space Complexity: O(1)
+__attribute__((target("avx2")))
+double sumLanes4(__m256d v)
+{
+    double lanes[4];
+    _mm256_storeu_pd(lanes, v);
+    return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+}
+
+// Sum of the 8 lanes: the 256-bit halves, then the 128-bit halves are added, then one hadd
+// Same order as _mm512_reduce_add_pd. GCC 12 warns about an uninitialized variable in that one and in
+// the unmasked extract (both start from _mm256_undefined_pd), the zero-masked extract does not.
+// Time Complexity: O(1)
+// Space Complexity: O(1)
+__attribute__((target("avx512f")))
+double sumLanes8(__m512d v)
+{
+    __m256d half = _mm256_add_pd(_mm512_maskz_extractf64x4_pd(0xFF, v, 0), _mm512_maskz_extractf64x4_pd(0xFF, v, 1));
+    __m128d quarter = _mm_add_pd(_mm256_castpd256_pd128(half), _mm256_extractf128_pd(half, 1));
+    return _mm_cvtsd_f64(_mm_hadd_pd(quarter, quarter));
+}
+
+// AVX2 kernel, 4 genes per step and a scalar tail for the remaining clients
+// Time Complexity: O(S * C / 4)
+// Space Complexity: O(1)
+__attribute__((target("avx2")))
+void fitnessKernelAvx2(const Gene* genes, const double* ideal, const double* latencyTotals,
+                       unsigned int numServers, unsigned int numClients,
+                       double* rowSums, double* colSums, double* latencyScore, unsigned int* zeroCount)
+{
+    const __m256d signMask = _mm256_set1_pd(-0.0);
+    const __m256d zero = _mm256_setzero_pd();
+    __m256d scoreAcc = _mm256_setzero_pd();
+    double scoreTail = 0.0;
+    unsigned int zeros = 0;
+    unsigned int vectorEnd = numClients & ~3u;
+
+    for (unsigned int i = 0; i < numClients; i++) {
+        colSums[i] = 0.0;
+    }
+
+    for (unsigned int j = 0; j < numServers; j++) {
+        const Gene* row = genes + (size_t)j * numClients;
+        const double* idealRow = ideal + (size_t)j * numClients;
+        __m256d rowAcc = _mm256_setzero_pd();
+
+        unsigned int i = 0;
+        for (; i < vectorEnd; i += 4) {
+            __m256d x = loadGenes4(row + i);
+            __m256d diff = _mm256_andnot_pd(signMask, _mm256_sub_pd(_mm256_loadu_pd(idealRow + i), x));
+            scoreAcc = _mm256_add_pd(scoreAcc, _mm256_mul_pd(_mm256_loadu_pd(latencyTotals + i), diff));
+            rowAcc = _mm256_add_pd(rowAcc, x);
+            _mm256_storeu_pd(colSums + i, _mm256_add_pd(_mm256_loadu_pd(colSums + i), x));
+            zeros += __builtin_popcount(_mm256_movemask_pd(_mm256_cmp_pd(x, zero, _CMP_EQ_OQ)));
+        }
+
+        double rowSum = sumLanes4(rowAcc);
+        for (; i < numClients; i++) {
+            double x = row[i];
+            double diff = idealRow[i] - x;
+            scoreTail += latencyTotals[i] * (diff < 0 ? -diff : diff);
+            rowSum += x;
+            colSums[i] += x;
+            zeros += (x == 0);
+        }
+        rowSums[j] = rowSum;
+    }
+
+    *latencyScore = sumLanes4(scoreAcc) + scoreTail;
+    *zeroCount = zeros;
+}
+
+// AVX-512 kernel, 8 genes per step and a masked step for the remaining clients
+// Time Complexity: O(S * C / 8)
+// Space Complexity: O(1)
+__attribute__((target("avx512f")))
+void fitnessKernelAvx512(const Gene* genes, const double* ideal, const double* latencyTotals,
+                         unsigned int numServers, unsigned int numClients,
+                         double* rowSums, double* colSums, double* latencyScore, unsigned int* zeroCount)
+{
+    const __m512d zero = _mm512_setzero_pd();
+    __m512d scoreAcc = _mm512_setzero_pd();
+    unsigned int zeros = 0;
+    unsigned int vectorEnd = numClients & ~7u;
+    __mmask8 tailMask = (__mmask8)((1u << (numClients - vectorEnd)) - 1);
+
+    for (unsigned int i = 0; i < numClients; i++) {
+        colSums[i] = 0.0;
+    }
+
+    for (unsigned int j = 0; j < numServers; j++) {
+        const Gene* row = genes + (size_t)j * numClients;
+        const double* idealRow = ideal + (size_t)j * numClients;
+        __m512d rowAcc = _mm512_setzero_pd();
+
+        unsigned int i = 0;
+        for (; i < vectorEnd; i += 8) {
+            __m512d x = loadGenes8(row + i);
+            __m512d diff = _mm512_abs_pd(_mm512_sub_pd(_mm512_loadu_pd(idealRow + i), x));
+            scoreAcc = _mm512_fmadd_pd(_mm512_loadu_pd(latencyTotals + i), diff, scoreAcc);
+            rowAcc = _mm512_add_pd(rowAcc, x);
+            _mm512_storeu_pd(colSums + i, _mm512_add_pd(_mm512_loadu_pd(colSums + i), x));
+            zeros += __builtin_popcount(_mm512_cmp_pd_mask(x, zero, _CMP_EQ_OQ));
+        }
+
+        if (tailMask) {
+            // Masked lanes load as 0 and are excluded from the zero count by the mask
+            __m512d x = maskLoadGenes8(tailMask, row + i, numClients - vectorEnd);
+            __m512d diff = _mm512_abs_pd(_mm512_sub_pd(_mm512_maskz_loadu_pd(tailMask, idealRow + i), x));
+            scoreAcc = _mm512_fmadd_pd(_mm512_maskz_loadu_pd(tailMask, latencyTotals + i), diff, scoreAcc);
+            rowAcc = _mm512_add_pd(rowAcc, x);
+            _mm512_mask_storeu_pd(colSums + i, tailMask, _mm512_add_pd(_mm512_maskz_loadu_pd(tailMask, colSums + i), x));
+            zeros += __builtin_popcount(_mm512_mask_cmp_pd_mask(tailMask, x, zero, _CMP_EQ_OQ));
+        }
+        rowSums[j] = sumLanes8(rowAcc);
+    }
+
+    *latencyScore = sumLanes8(scoreAcc);
+    *zeroCount = zeros;
+}
+
+#endif
+
+// Picks the kernel: the one forced by KERNEL_METHOD or the widest one the CPU supports
+// Time Complexity: O(1)
+// Space Complexity: O(1)
+FitnessKernel selectFitnessKernel(int method = KERNEL_METHOD)
+{
+#ifdef FITNESS_KERNELS_X86
+    __builtin_cpu_init();
+    bool hasAvx512 = __builtin_cpu_supports("avx512f");
+    bool hasAvx2 = __builtin_cpu_supports("avx2");
+    if ((method == 0 || method == 3) && hasAvx512) {
+        return fitnessKernelAvx512;
+    }
+    if ((method == 0 || method == 2 || method == 3) && hasAvx2) {
+        return fitnessKernelAvx2;
+    }
+#endif
+    return fitnessKernelScalar;
+}
+
+// Name of a kernel, for logs and benchmarks
+// Time Complexity: O(1)
+// Space Complexity: O(1)
+const char* fitnessKernelName(FitnessKernel kernel)
+{
+#ifdef FITNESS_KERNELS_X86
+    if (kernel == fitnessKernelAvx512) {
+        return "avx512";
+    }
+    if (kernel == fitnessKernelAvx2) {
+        return "avx2";
+    }
+#endif
+    return "scalar";
+}
+
+// Kernel used by the evaluation, chosen once when the program starts
+FitnessKernel fitnessKernel = selectFitnessKernel();
+
+#endif
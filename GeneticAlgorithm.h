@@ -1,9 +1,21 @@
+#ifndef GENETICALGORITHM_H
+#define GENETICALGORITHM_H
+
 // Genetic Algorithm Implementation
+// The operators are policy types plugged into the GeneticAlgorithm<Selection, Crossover, Mutation,
+// Survivor, Penalty> engine, so each gene loop is compiled for one operator without runtime checks.
+// The *_METHOD and ELITISM macros are the defaults of GAConfig, which picks one of the prebuilt
+// instantiations at runtime (see dispatchEngine()).
+//
 // Constants and Macros:
 // - POPULATION: Size of the population.
 // - GENERATIONS: Number of generations.
-// - PENALTY_METHOD: Type of penalty method used (1 -> static).
-// - PENALTY_CONSTANT: Penalty constant for constraint violations.
+// - PENALTY_METHOD: Type of penalty method used (1 -> static, 2 -> generation-scheduled, 3 -> adaptive).
+// - PENALTY_CONSTANT: Penalty per unit of excess load and per unconnected pair, scaled once more by the policy weight.
+// - PENALTY_SCHEDULE_C, PENALTY_SCHEDULE_ALPHA: Weight (C * generation)^ALPHA of the generation-scheduled penalty.
+// - PENALTY_TARGET_FEASIBLE: Feasible share of the population the adaptive penalty steers to.
+// - PENALTY_ADAPT_RATE: Factor the adaptive weight is multiplied or divided by after each generation.
+// - PENALTY_WEIGHT_MIN, PENALTY_WEIGHT_MAX: Range of the weight of the scheduled and adaptive penalties.
 // - ELITISM: Boolean to determine whether elitism is used.
 // - SELECTION_METHOD: Selection method (1 -> binary tournament).
 // - CROSSOVER_METHOD: Crossover method (1 -> BLX-alpha, 2 -> SBX).
@@ -12,18 +24,53 @@
 // - crossoverProbability: Probability of crossover.
 // - MUTATION_METHOD: Mutation method (1 -> random mutation).
 // - mutationProbability: Probability of mutation.
+// - WORKER_THREADS: Threads used by evaluate() and variation() (0 -> all hardware threads, 1 -> serial).
+// - FULL_EVALUATION_INTERVAL: Generations between full re-evaluations that flush incremental drift.
+// - FITNESS_MEMO: Reuse the evaluation of identical individuals within a full evaluation pass.
+// - STAGNATION_GENERATIONS: Stop after N generations without improvement of the best fitness (0 -> never).
+// - STAGNATION_TOLERANCE: Relative improvement of the best fitness that still counts as progress.
+// - TARGET_FITNESS: Stop as soon as the best fitness is at or below this value.
+// - MIN_DIVERSITY: Stop once the population diversity falls below this value (0 -> never), see populationDiversity().
+// - DIVERSITY_INTERVAL: Generations between two diversity measurements (stopping criterion and telemetry).
+// - TIME_BUDGET: Wall-clock budget of a run in seconds (0 -> no deadline).
+// - WARM_START_FRESH: Share of a warm-started population generated at random instead of kept from the previous run.
+// - SEED_FRACTION: Share of the initial population built by constructive heuristics instead of at random.
+// - SEED_PERTURBATION: Relative noise added to every gene of a heuristic individual, so seeds differ.
+// - GENE_FLOOR: Share of its ideal allocation a gene keeps at least in the greedy seed and after a repair,
+//   a zero gene costs a connection penalty.
+// - REPAIR_SLACK: Relative margin below a bandwidth or capacity that repairIndividual() scales to.
+// - REPAIR_OFFSPRING: Repair every infeasible offspring after evaluation (see repairIndividual()).
+// - LOCAL_SEARCH_ELITES: Number of best individuals polished by a bounded local search after survivor selection.
+// - LOCAL_SEARCH_STEPS: Moves tried on each of these elites per generation, each one costs O(1).
+// - LOCAL_SEARCH_STEP: Largest relative change of a gene in a random local search move.
+// - MULTI_OBJECTIVE: Default of GAConfig::multiObjective, NSGA-II on latency score, load imbalance and violation.
+// - PROFILE_REPORT: Default of GAConfig::profile, time every phase and print a summary at the end of a run (see Profiler.h).
 
 #include "Task.h"
 #include "Chromosome.h"
+#include "ThreadPool.h"
+#include "Random.h"
+#include "FitnessKernels.h"
+#include "Telemetry.h"
+#include "Profiler.h"
 #include <algorithm>
-#include <random>
 #include <cmath>
 #include <iomanip> 
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <mutex>
 
 #define POPULATION 1000
 #define GENERATIONS 2000
-#define PENALTY_METHOD 1 // 1 -> static
+#define PENALTY_METHOD 1 // 1 -> static, 2 -> generation-scheduled, 3 -> adaptive (feasible ratio feedback)
 #define PENALTY_CONSTANT 100 // The initial penalty constant for constraints
+#define PENALTY_SCHEDULE_C 0.02 // Scheduled weight reaches 1 (the static penalty) at generation 1 / C
+#define PENALTY_SCHEDULE_ALPHA 2
+#define PENALTY_TARGET_FEASIBLE 0.5
+#define PENALTY_ADAPT_RATE 1.2
+#define PENALTY_WEIGHT_MIN 1e-3
+#define PENALTY_WEIGHT_MAX 1e6
 #define ELITISM true // true -> elitist_full, false -> non_elitist
 #define SELECTION_METHOD 1 // 1 -> binary tournament
 #define CROSSOVER_METHOD 2 // 1 -> BLX-alpha, 2 -> SBX
@@ -32,12 +79,111 @@
 #define crossoverProbability 0.9 // Probability of crossover
 #define MUTATION_METHOD 1 // 1 -> random
 #define mutationProbability 0.2 // Probability of mutation
-#define Verbose true // set true to see all the logs
+#define WORKER_THREADS 0 // 0 -> one per hardware thread
+#define FULL_EVALUATION_INTERVAL 50 // Every individual is fully re-evaluated every N generations
+#define FITNESS_MEMO true // true -> duplicates share one kernel pass, false -> every individual is evaluated
+#define Verbose true // set true to see all the logs (default of GAConfig::verbose)
+#define STAGNATION_GENERATIONS 200 // 0 -> run every generation
+#define STAGNATION_TOLERANCE 1e-9 // Smaller relative improvements count as stagnation
+#define TARGET_FITNESS 0 // Fitness is never negative, 0 -> only stop on a perfect score
+#define MIN_DIVERSITY 0 // 0 -> never stop on diversity collapse, around 1e-6 stops once the population is made of copies
+#define DIVERSITY_INTERVAL 10 // Diversity costs about one evaluation pass, so it is not measured every generation
+#define TIME_BUDGET 0 // Seconds, 0 -> no deadline
+#define WARM_START_FRESH 0.1 // The rest of a warm start is the best of the previous population, repaired
+#define SEED_FRACTION 0.1 // 0 -> fully random initial population
+#define SEED_PERTURBATION 0.2 // Genes of a seed are scaled by a factor in [1 - p, 1 + p)
+#define GENE_FLOOR 0.01
+#define REPAIR_SLACK 1e-9 // Relative margin repairIndividual() leaves below a bound
+#define REPAIR_OFFSPRING false // false -> infeasibility is only penalized (--repair turns repair on)
+#define LOCAL_SEARCH_ELITES 0 // Best individuals polished by local search every generation (0 -> no local search, see --local-search)
+#define LOCAL_SEARCH_STEPS 50 // Moves tried on each elite per generation
+#define LOCAL_SEARCH_STEP 0.1 // Largest relative change of a gene by a random move
+#define MULTI_OBJECTIVE false // true -> Pareto front of (latency, load imbalance, violation) instead of one weighted fitness
+#define OBJECTIVES 3 // Latency score, load imbalance, violation
+#define PROFILE_REPORT false // true -> per-phase timings and counters after every run
 
 using namespace std;
 
-vector<unsigned int> upperBounds; // Upper bounds for allocation constraints
-Task current1; // Current task being solved
+// State of one solve: the task and the tables derived from it. The solver functions read the context
+// bound to their thread (see SolveScope), so solves on different threads can run different tasks at once.
+struct SolveContext
+{
+    Task task; // Task being solved, frozen
+    vector<unsigned int> upperBounds; // Upper bounds for allocation constraints, see findUpperBound()
+};
+
+thread_local SolveContext* activeSolve = nullptr; // Context of the solve running on this thread
+
+// Binds a context to the calling thread until the end of the scope, then restores the previous one
+class SolveScope
+{
+    private:
+    SolveContext* previous;
+
+    public:
+    SolveScope(SolveContext& context); // Binds context.
+    ~SolveScope(); // Restores the previous binding.
+    SolveScope(const SolveScope&) = delete;
+    SolveScope& operator=(const SolveScope&) = delete;
+};
+
+// Time Comp: O(1)
+// Space Comp: O(1)
+SolveScope::SolveScope(SolveContext& context)
+{
+    previous = activeSolve;
+    activeSolve = &context;
+}
+
+// Time Comp: O(1)
+// Space Comp: O(1)
+SolveScope::~SolveScope()
+{
+    activeSolve = previous;
+}
+
+// pool.parallelFor with the context of the calling thread bound on every thread that runs a chunk
+// Time Comp: O(1) per chunk plus the cost of body
+// Space Comp: O(1)
+template <class Body>
+void parallelSolve(ThreadPool& pool, size_t count, const Body& body)
+{
+    SolveContext* context = activeSolve;
+    pool.parallelFor(count, [context, &body](size_t begin, size_t end) {
+        activeSolve = context; // Workers are reused by other solves, so the binding is set for every chunk
+        body(begin, end);
+    });
+}
+
+// Where the genes of a chromosome sit in the S x C allocation matrix, taken from the frozen task.
+// Dense task: server i owns genes [i * C, (i + 1) * C) and the client is the offset in the row.
+// Sparse task: server i owns genes [edgeStart[i], edgeStart[i + 1]) and edgeClients names their clients.
+// Operators loop over servers and their genes, so the same loop serves both modes.
+struct GeneLayout
+{
+    const unsigned int* edgeStart; // S + 1 row offsets
+    const unsigned int* edgeClients; // Client of each gene, null for a dense task
+
+    unsigned int client(unsigned int server, unsigned int gene) const; // Client of a gene.
+};
+
+// Layout of the current task, valid after activeSolve->task.freeze()
+// Time Comp: O(1)
+// Space Comp: O(1)
+GeneLayout geneLayout()
+{
+    GeneLayout layout;
+    layout.edgeStart = activeSolve->task.getEdgeStart();
+    layout.edgeClients = activeSolve->task.getEdgeClients();
+    return layout;
+}
+
+// Time Comp: O(1)
+// Space Comp: O(1)
+unsigned int GeneLayout::client(unsigned int server, unsigned int gene) const
+{
+    return edgeClients ? edgeClients[gene] : gene - edgeStart[server];
+}
 
 // Compare function for sorting chromosomes based on fitness
 // Time Comp: O(1)
@@ -49,208 +195,345 @@ bool compareByFitness(const Chromosome& a, const Chromosome& b)
 
 // Function prototypes
 void findUpperBound();
-Chromosome generateIndividual();
-vector<Chromosome> generateRandomPopulation();
-void evaluate(vector<Chromosome>&);
-vector<Chromosome> selection(vector<Chromosome>&);
-void variation(vector<Chromosome>&);
-void crossover(Chromosome&, Chromosome&);
-double blxaCrossover(double, double, int);
-void sbxCrossover(Chromosome&, Chromosome&, int, int);
-void mutation(Chromosome&);
-vector<Chromosome> survivor(vector<Chromosome>&, vector<Chromosome>&);
-void printPopulation(vector<Chromosome>&);
+void generateIndividual(Chromosome&, Rng&);
+Population generateRandomPopulation(const RandomStreams&, ThreadPool* = nullptr, unsigned int = POPULATION);
+Population generateSeededPopulation(const RandomStreams&, ThreadPool* = nullptr, unsigned int = POPULATION, double = SEED_FRACTION);
+void generateHeuristicIndividual(Chromosome&, Rng&, unsigned int);
+Population reseedPopulation(const Population&, const RandomStreams&, ThreadPool* = nullptr, unsigned int = POPULATION, double = WARM_START_FRESH);
+void repairIndividual(Chromosome&);
+template <class Penalty>
+void evaluate(Population&, const Penalty&, ThreadPool* = nullptr, bool = false, Profiler* = nullptr);
+void fillOffspring(Population&, const Population&, const vector<unsigned int>&, ThreadPool* = nullptr);
+void calculateLatencyScore(Chromosome&);
 void calculatePenalty(Chromosome&);
+void penaltiesFromSums(Chromosome&, const double*, const double*, unsigned int);
+template <class Penalty>
+void computeFitness(Chromosome&, const Penalty&);
+void evaluateIndividual(Chromosome&);
+void updateGene(Chromosome&, unsigned int, unsigned int, unsigned int, double);
 void printIndividual(Chromosome&);
 
-// Survivor selection based on elitism -> elitist_full and non-elitist
-// Time Comp: O(POP*logn(POP)) 
-// Space Comp: O(1)
-vector<Chromosome> survivor(vector<Chromosome>& offspring, vector<Chromosome>& parentPop)
-{
-    vector<Chromosome> newParent;
-    if (ELITISM) {
-
-        // Sort both offspring and parent population by fitness so then we can combine them into one
-        sort(offspring.begin(), offspring.end(), compareByFitness); // O(POP * log(POP)) sorting algorithmn
-        sort(parentPop.begin(), parentPop.end(), compareByFitness); // O(POP * log(POP)) sorting algorithmn
-
-        int offspringIndx = 0;
-        int ParentIndx = 0;
-        for (int i = 0; i < POPULATION; i++) { //TC: O(POP) SC: O(POP) 
-            if (offspring[offspringIndx].fitness < parentPop[ParentIndx].fitness) {
-                newParent.push_back(offspring[offspringIndx++]);
-            } else {
-                newParent.push_back(parentPop[ParentIndx++]);
-            }
+// Copies the selected parents into the offspring buffer, which variation() then modifies in place
+// Time Complexity: O(POP * S * C / T), one memcpy per individual
+// Space Complexity: O(1) the offspring buffer is reused from one generation to the next
+void fillOffspring(Population& offspring, const Population& pop, const vector<unsigned int>& matingPool, ThreadPool* pool) {
+    auto copyRange = [&offspring, &pop, &matingPool](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            offspring[i].copyFrom(pop[matingPool[i]]);
         }
+    };
+
+    if (pool) {
+        parallelSolve(*pool, matingPool.size(), copyRange);
     } else {
-        newParent = offspring; // Non-elitist approach
+        copyRange(0, matingPool.size());
     }
-    return newParent;
 }
 
-// Performs crossover between two chromosomes (off1 and off2).
-// Supports two crossover methods:
-// CROSSOVER_METHOD == 1 BLX-alpha (Blend Crossover Alpha): Generates offspring by blending values with a factor determined by alpha.
-// CROSSOVER_METHOD == 2 SBX (Simulated Binary Crossover): Mimics binary crossover in continuous search spaces.
-// Time Comp: O(S*C) S stands for server number, C stands for client number
-// Space Comp: O(1) all the things passed by reference
-void crossover(Chromosome& off1, Chromosome& off2) {
-    if (CROSSOVER_METHOD == 1) {
-        // BLX-alpha crossover
-        // Iterate each server and client combination
-        for (int i = 0; i < current1.getNumServers(); i++) {
-            for (int j = 0; j < current1.getNumClients(); j++) {
-
-                // Generate two new values for offspring using the BLX-alpha method
-                double newVal1 = blxaCrossover(off1.ServerAllocations[i][j], off2.ServerAllocations[i][j], j);
-                double newVal2 = blxaCrossover(off1.ServerAllocations[i][j], off2.ServerAllocations[i][j], j);
-                // Assign the new values to the offspring
-                off1.ServerAllocations[i][j] = newVal1;
-                off2.ServerAllocations[i][j] = newVal2;
-            }
+// Function to generate a random individual in place
+// Time Complexity: O(S*C) S stands for server number, C stands for client number (O(E) reachable pairs if sparse)
+// Space Complexity: O(1) the genes already live in the population arena
+void generateIndividual(Chromosome& individual, Rng& rng) {
+    //randomly generate individual respect to bounds
+    individual.cacheValid = false; // Genes are written directly, the next evaluation is a full one
+    individual.modified = true;
+    GeneLayout layout = geneLayout();
+    for (unsigned int i = 0; i < individual.numServers; i++) {
+        for (unsigned int k = layout.edgeStart[i]; k < layout.edgeStart[i + 1]; k++) {
+            individual.ServerAllocations[k] = toGene(rng.bounded(activeSolve->upperBounds[layout.client(i, k)]));
         }
-    } else if (CROSSOVER_METHOD == 2) {
+    }
+}
 
-        // SBX (Simulated Binary Crossover)
-        // Iterate each server and client combination
-        for (int i = 0; i < current1.getNumServers(); i++) {
-            for (int j = 0; j < current1.getNumClients(); j++) {
+// Smallest gene the seeds and repairs leave on a pair: GENE_FLOOR of its ideal allocation, at least
+// one unit for integer genes, so no gene is 0 (connection penalty)
+// Time Complexity: O(1)
+// Space Complexity: O(1)
+Gene minimumGene(double ideal) {
+    return toGene(GENE_INTEGER ? ceil(GENE_FLOOR * ideal) : GENE_FLOOR * ideal);
+}
 
-                // Apply SBX crossover
-                sbxCrossover(off1, off2, i, j);
-                sbxCrossover(off1, off2, i, j);
-            }
-        }
-    }
+// Adds up to amount to a gene, rounded down to the gene type, and returns what was actually added
+// Time Complexity: O(1)
+// Space Complexity: O(1)
+double raiseGene(Gene& gene, double amount) {
+    Gene raised = toGeneFloor(gene + amount);
+    double added = (double)raised - gene;
+    gene = raised;
+    return added;
 }
 
-// SBX Crossover
+// Scales a gene down, rounded down so scaled sums stay below their bound, a positive gene keeps at least
+// one unit when genes are integers (floats and doubles stay positive anyway)
 // Time Complexity: O(1)
 // Space Complexity: O(1)
-void sbxCrossover(Chromosome& off1, Chromosome& off2, int index1, int index2) {
-    double x1 = off1.ServerAllocations[index1][index2];
-    double x2 = off2.ServerAllocations[index1][index2];
+Gene scaleGene(Gene gene, double scale) {
+    Gene scaled = toGeneFloor(gene * scale);
+    return GENE_INTEGER && scaled == 0 && gene > 0 ? (Gene)1 : scaled;
+}
 
-    double k = ((double)rand() / RAND_MAX); // Generate random value [0, 1]
-    double beta;
+// Heuristic seeds
+// Each one builds an individual close to the feasible region, perturbs it and repairs it, so the
+// first generations do not go to escaping the penalties of a random start.
 
-    if (k <= 0.5) {
-        beta = pow(2 * k, 1.0 / (CROSSOVER_ETA + 1));
-    } else {
-        beta = pow(1.0 / (2 * (1 - k)), 1.0 / (CROSSOVER_ETA + 1));
+// Multiplies every gene by a random factor in [1 - SEED_PERTURBATION, 1 + SEED_PERTURBATION)
+// Time Complexity: O(S*C)
+// Space Complexity: O(1)
+void perturbGenes(Chromosome& individual, Rng& rng) {
+    for (unsigned int k = 0; k < individual.size(); k++) {
+        individual.ServerAllocations[k] = toGene(individual.ServerAllocations[k] * (1.0 + SEED_PERTURBATION * (2.0 * rng.uniform() - 1.0)));
     }
+}
 
-    //Formulation of SBX crossover
-    double y1 = 0.5 * ((1 + beta) * x1 + (1 - beta) * x2); 
-    double y2 = 0.5 * ((1 - beta) * x1 + (1 + beta) * x2);
+// Latency-proportional split: every client's bandwidth is shared by its servers in proportion to
+// their inverse latency, which is the ideal allocation of the objective (latency score 0)
+// Time Complexity: O(S*C)
+// Space Complexity: O(1)
+void seedLatencyProportional(Chromosome& individual, Rng& rng) {
+    const double* ideal = activeSolve->task.getIdealAllocations();
+    for (unsigned int k = 0; k < individual.size(); k++) {
+        individual.ServerAllocations[k] = toGene(ideal[k]);
+    }
+    perturbGenes(individual, rng);
+}
 
-    // Clamp values to valid bounds
-    y1 = max(min(y1, (double)upperBounds[index2]), 0.0);
-    y2 = max(min(y2, (double)upperBounds[index2]), 0.0);
+// Even split (round-robin): every client's bandwidth is shared equally by the servers it reaches
+// The cached client loads count the servers of each client first.
+// Time Complexity: O(S*C)
+// Space Complexity: O(1)
+void seedEvenSplit(Chromosome& individual, Rng& rng) {
+    GeneLayout layout = geneLayout();
+    double* reach = individual.clientLoads;
+    fill(reach, reach + individual.numClients, 0.0);
+    for (unsigned int i = 0; i < individual.numServers; i++) {
+        for (unsigned int k = layout.edgeStart[i]; k < layout.edgeStart[i + 1]; k++) {
+            reach[layout.client(i, k)] += 1;
+        }
+    }
+    for (unsigned int i = 0; i < individual.numServers; i++) {
+        for (unsigned int k = layout.edgeStart[i]; k < layout.edgeStart[i + 1]; k++) {
+            unsigned int client = layout.client(i, k);
+            individual.ServerAllocations[k] = toGene(activeSolve->task.getBandwith(client) / reach[client]);
+        }
+    }
+    perturbGenes(individual, rng);
+}
 
+// Greedy capacity-aware fill: every gene keeps GENE_FLOOR of its ideal allocation, then servers (from a
+// random one on) take as much of their ideal allocations as their capacity allows, and a second pass
+// moves the bandwidth clients still miss to the servers with capacity left.
+// The cached loads hold the remaining capacity of each server and the missing bandwidth of each client.
+// Time Complexity: O(S*C)
+// Space Complexity: O(1)
+void seedGreedyFill(Chromosome& individual, Rng& rng) {
+    GeneLayout layout = geneLayout();
+    const double* ideal = activeSolve->task.getIdealAllocations();
+    Gene* genes = individual.ServerAllocations;
+    double* serverLeft = individual.serverLoads;
+    double* clientLeft = individual.clientLoads;
 
-    //Assigns new values to proper genes
-    off1.ServerAllocations[index1][index2] = y1;
-    off2.ServerAllocations[index1][index2] = y2;
+    for (unsigned int j = 0; j < individual.numClients; j++) {
+        clientLeft[j] = activeSolve->task.getBandwith(j);
+    }
+    for (unsigned int i = 0; i < individual.numServers; i++) {
+        serverLeft[i] = activeSolve->task.getCapacity(i);
+        for (unsigned int k = layout.edgeStart[i]; k < layout.edgeStart[i + 1]; k++) {
+            genes[k] = minimumGene(ideal[k]);
+            serverLeft[i] -= genes[k];
+            clientLeft[layout.client(i, k)] -= genes[k];
+        }
+    }
+
+    unsigned int first = rng.bounded(individual.numServers);
+    for (unsigned int pass = 0; pass < 2; pass++) {
+        for (unsigned int s = 0; s < individual.numServers; s++) {
+            unsigned int i = (first + s) % individual.numServers;
+            for (unsigned int k = layout.edgeStart[i]; k < layout.edgeStart[i + 1] && serverLeft[i] > 0; k++) {
+                unsigned int client = layout.client(i, k);
+                double wanted = pass == 0 ? (1.0 - GENE_FLOOR) * ideal[k] : clientLeft[client];
+                double amount = raiseGene(genes[k], max(min(min(wanted, clientLeft[client]), serverLeft[i]), 0.0));
+                serverLeft[i] -= amount;
+                clientLeft[client] -= amount;
+            }
+        }
+    }
+    perturbGenes(individual, rng);
 }
 
-// BLX-alpha Crossover
-// Time Complexity: O(1)
+// Builds heuristic individual number `strategy` (0 -> latency-proportional, 1 -> greedy fill, 2 -> even split)
+// The result is repaired, so it is within every bandwidth and (up to the greedy floors) every capacity.
+// Time Complexity: O(S*C)
 // Space Complexity: O(1)
-double blxaCrossover(double p1, double p2, int clientNum) {
-    double minVal = min(p1, p2); //Find the min one
-    double maxVal = max(p1, p2); //Find the max one
-    double u = ((double)rand() / RAND_MAX); //generate random number between 0 to 1
-    double gamma = ((1.0 + 2.0 * CROSSOVER_ALPHA) * u) - CROSSOVER_ALPHA; //gamma formulation
-    double off = ((1.0 - gamma) * minVal) + (gamma * maxVal); //find new offspring values
-    off = max(min(off, (double)upperBounds[clientNum]), 0.0); //bound check
-    return off;
+void generateHeuristicIndividual(Chromosome& individual, Rng& rng, unsigned int strategy) {
+    switch (strategy % 3) {
+        case 0: seedLatencyProportional(individual, rng); break;
+        case 1: seedGreedyFill(individual, rng); break;
+        default: seedEvenSplit(individual, rng); break;
+    }
+    repairIndividual(individual);
 }
 
-
-// Function to apply mutation on a chromosome
-// Time Complexity: O(S*C) C stands for number of server, C stands for number of clients
-// Space Complexity: O(1) constant
-void mutation(Chromosome& off1) {
-    if (MUTATION_METHOD == 1) {
-        for (int i = 0; i < off1.ServerAllocations.size(); i++) {
-            for (int j = 0; j < off1.ServerAllocations[0].size(); j++) {
-
-                // Randomly mutate gene based on a 50% probability
-                if (rand() % 2 == 1) {
-                    off1.ServerAllocations[i][j] = rand() % upperBounds[j];
-                }
+// Function to generate an initial population of which seedFraction is built by the heuristic seeds
+// The strategies take turns, the rest of the population is random. Individual i draws from its own
+// stream, so the population is the same for any number of threads, and seedFraction 0 gives
+// the population of generateRandomPopulation().
+// Time Complexity: O(POP * S*C / T)
+// Space Complexity: O(POP * S*C)
+Population generateSeededPopulation(const RandomStreams& streams, ThreadPool* pool, unsigned int populationSize, double seedFraction) {
+    Population ans(populationSize, activeSolve->task.getNumServers(), activeSolve->task.getNumClients(), activeSolve->task.getNumGenes());
+    size_t seeded = min<size_t>(populationSize, (size_t)ceil(max(seedFraction, 0.0) * populationSize));
+    auto generateRange = [&ans, &streams, seeded](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            Rng rng = streams.stream(PHASE_INITIALIZATION, 0, i);
+            if (i < seeded) {
+                generateHeuristicIndividual(ans[i], rng, i); //TC: O(S*C)
+            } else {
+                generateIndividual(ans[i], rng); //TC: O(S*C)
             }
         }
+    };
+
+    if (pool) {
+        parallelSolve(*pool, ans.size(), generateRange);
+    } else {
+        generateRange(0, ans.size());
+    }
+    return ans;
+}
+
+// Function to generate a random population
+// Individual i draws from its own stream, so the population is the same for any number of threads
+// Time Complexity: O(POP * S*C / T) POP is population size S stands for server number, C stands for client number, T stands for threads
+// Space Complexity: O(POP * S*C) one contiguous arena for the whole population
+Population generateRandomPopulation(const RandomStreams& streams, ThreadPool* pool, unsigned int populationSize) {
+    Population ans(populationSize, activeSolve->task.getNumServers(), activeSolve->task.getNumClients(), activeSolve->task.getNumGenes());
+    auto generateRange = [&ans, &streams](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            Rng rng = streams.stream(PHASE_INITIALIZATION, 0, i);
+            generateIndividual(ans[i], rng); //TC: O(S*C)
+        }
+    };
+
+    if (pool) {
+        parallelSolve(*pool, ans.size(), generateRange);
+    } else {
+        generateRange(0, ans.size());
     }
+    return ans;
 }
 
-// Function to select parents for mating using tournament selection
-// Time Complexity: O(POP) POP stands for size of population
-// Space Complexity: O(POP) POP stands for size of population, it creates matingPool
-vector<Chromosome> selection(vector<Chromosome>& pop) {
-    vector<Chromosome> mating;
-    if (SELECTION_METHOD == 1) {
-        for (int i = 0; i < pop.size(); i++) {
-            // Select two random chromosomes and pick the one with better fitness
-            int index1 = rand() % pop.size();
-            int index2 = rand() % pop.size();
-            pop[index1].fitness < pop[index2].fitness ? mating.push_back(pop[index1]) : mating.push_back(pop[index2]);
+// Function to build a warm-start population from the final population of a previous run
+// The previous individuals are kept best first (by their old fitness) and repaired under the current
+// bounds, at least freshFraction of the population is generated at random so the run does not start collapsed.
+// previous must have the gene layout of the current task.
+// Time Complexity: O(P log P + P * S*C / T)
+// Space Complexity: O(P * S*C)
+Population reseedPopulation(const Population& previous, const RandomStreams& streams, ThreadPool* pool, unsigned int populationSize, double freshFraction) {
+    Population ans(populationSize, activeSolve->task.getNumServers(), activeSolve->task.getNumClients(), activeSolve->task.getNumGenes());
+    vector<unsigned int> order(previous.size());
+    for (unsigned int k = 0; k < order.size(); k++) {
+        order[k] = k;
+    }
+    stable_sort(order.begin(), order.end(), [&previous](unsigned int a, unsigned int b) { return previous[a].fitness < previous[b].fitness; });
+    size_t kept = min<size_t>(order.size(), populationSize - (size_t)ceil(freshFraction * populationSize));
+
+    auto seedRange = [&ans, &previous, &order, &streams, kept](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            if (i < kept) {
+                memcpy(ans[i].ServerAllocations, previous[order[i]].ServerAllocations, sizeof(Gene) * ans[i].size());
+                repairIndividual(ans[i]); //TC: O(S*C)
+            } else {
+                Rng rng = streams.stream(PHASE_INITIALIZATION, 0, i);
+                generateIndividual(ans[i], rng); //TC: O(S*C)
+            }
         }
+    };
+
+    if (pool) {
+        parallelSolve(*pool, ans.size(), seedRange);
+    } else {
+        seedRange(0, ans.size());
     }
-    return mating;
+    return ans;
 }
 
-// Function to apply crossover and mutation on offspring
-// Time Complexity: O(POP * (S*C)) S*C is time complexity of mutation, POP stands for population size
-// Space complexity: O(1)
-void variation(vector<Chromosome>& offspring) {
-    for (int i = 0; i < POPULATION; i += 2) {
-        // Apply crossover with a given probability
-        if (rand() % 100 < crossoverProbability * 100) {
-            crossover(offspring[i], offspring[i + 1]); //TC: O(S*C)
+// Function to project an individual back onto the constraints of the current task
+// 1. Genes are clamped between GENE_FLOOR of their ideal allocation (no zero gene, no connection
+//    penalty) and their client's upper bound.
+// 2. Every client allocated more than its bandwidth is scaled down, then every server loaded beyond its
+//    capacity. Scaling a server only lowers genes, so its clients stay within their bandwidth.
+// 3. The bandwidth clients lost to step 2 is redistributed: genes below their ideal allocation are
+//    raised towards it while their client misses bandwidth and their server has capacity left.
+// Scaled sums land REPAIR_SLACK below their bound, so rounding cannot leave them one ulp above it.
+// Scaled and raised genes are rounded down to the gene type. Integer genes keep one unit when they are
+// scaled, so a server shared by more clients than its capacity can stay over it.
+// The cached loads are used as scratch, the next evaluation of the individual is a full one.
+// Time Complexity: O(S*C) (O(E) reachable pairs if sparse)
+// Space Complexity: O(1)
+void repairIndividual(Chromosome& individual) {
+    GeneLayout layout = geneLayout();
+    const double* ideal = activeSolve->task.getIdealAllocations();
+    Gene* genes = individual.ServerAllocations;
+    double* serverLeft = individual.serverLoads; // Capacity left on each server
+    double* clientLeft = individual.clientLoads; // Client sums, then their scale factors, then the bandwidth they miss
+
+    fill(clientLeft, clientLeft + individual.numClients, 0.0);
+    for (unsigned int i = 0; i < individual.numServers; i++) {
+        for (unsigned int k = layout.edgeStart[i]; k < layout.edgeStart[i + 1]; k++) {
+            unsigned int client = layout.client(i, k);
+            genes[k] = min(max(genes[k], minimumGene(ideal[k])), toGene(activeSolve->upperBounds[client]));
+            clientLeft[client] += genes[k];
         }
+    }
+    for (unsigned int j = 0; j < individual.numClients; j++) {
+        double bandwidth = activeSolve->task.getBandwith(j);
+        clientLeft[j] = clientLeft[j] > bandwidth ? (1.0 - REPAIR_SLACK) * bandwidth / clientLeft[j] : 1.0;
+    }
 
-        // Apply mutation to the first and second offspring with given probabilities
-        if (rand() % 100 < mutationProbability * 100) {
-            mutation(offspring[i]); //TC: O(S*C)
+    for (unsigned int i = 0; i < individual.numServers; i++) {
+        double load = 0;
+        for (unsigned int k = layout.edgeStart[i]; k < layout.edgeStart[i + 1]; k++) {
+            genes[k] = scaleGene(genes[k], clientLeft[layout.client(i, k)]);
+            load += genes[k];
         }
-        if (rand() % 100 < mutationProbability * 100) {
-            mutation(offspring[i + 1]); //TC: O(S*C)
+        double capacity = (1.0 - REPAIR_SLACK) * activeSolve->task.getCapacity(i);
+        if (load > capacity) {
+            double scale = capacity / load;
+            load = 0;
+            for (unsigned int k = layout.edgeStart[i]; k < layout.edgeStart[i + 1]; k++) {
+                genes[k] = scaleGene(genes[k], scale);
+                load += genes[k];
+            }
         }
+        serverLeft[i] = capacity - load;
     }
-}
 
-// Function to generate a random individual
-// Time Complexity: O(S*C) S stands for server number, C stands for client number
-// Space Complexity: O(S*C) it creates a matrix respect to to number of server and clients
-Chromosome generateIndividual() {
-    Chromosome individual;
-    //randomly generate individual respect to bounds
-    individual.ServerAllocations = vector<vector<double>>(current1.getNumServers());
-    for (int i = 0; i < current1.getNumServers(); i++) {
-        individual.ServerAllocations[i] = vector<double>(current1.getNumClients());
-        for (int j = 0; j < current1.getNumClients(); j++) {
-            individual.ServerAllocations[i][j] = rand() % upperBounds[j];
+    fill(clientLeft, clientLeft + individual.numClients, 0.0);
+    for (unsigned int i = 0; i < individual.numServers; i++) {
+        for (unsigned int k = layout.edgeStart[i]; k < layout.edgeStart[i + 1]; k++) {
+            clientLeft[layout.client(i, k)] += genes[k];
         }
     }
-    return individual;
-}
-
-// Function to generate a random population
-// Time Complexity: O(POP * S*C) POP is population size S stands for server number, C stands for client number
-// Time Complexity: O(POP * S*C) POP is population size S stands for server number, C stands for client number
-vector<Chromosome> generateRandomPopulation() {
-    vector<Chromosome> ans;
-    for (int i = 0; i < POPULATION; i++) {
-        ans.push_back(generateIndividual()); //TC: O(S*C)
+    for (unsigned int j = 0; j < individual.numClients; j++) {
+        clientLeft[j] = max((1.0 - REPAIR_SLACK) * activeSolve->task.getBandwith(j) - clientLeft[j], 0.0);
     }
-    return ans;
+    for (unsigned int i = 0; i < individual.numServers; i++) {
+        for (unsigned int k = layout.edgeStart[i]; k < layout.edgeStart[i + 1] && serverLeft[i] > 0; k++) {
+            unsigned int client = layout.client(i, k);
+            double amount = min(min(ideal[k] - genes[k], clientLeft[client]), serverLeft[i]);
+            if (amount > 0) {
+                amount = raiseGene(genes[k], amount);
+                clientLeft[client] -= amount;
+                serverLeft[i] -= amount;
+            }
+        }
+    }
+    individual.cacheValid = false;
+    individual.modified = true;
 }
 
 // Function to print an individual's server allocations and fitness details
+// Unreachable pairs of a sparse task are printed as "-"
 // Time Complexity: O(S * C). S stands for server number, C stands for client number 
 // Space Complexity: O(1).
 void printIndividual(Chromosome& individual)
@@ -264,22 +547,28 @@ void printIndividual(Chromosome& individual)
 
     cout << "\n";
     cout << setw(15) << left << "Servers";  
-    for (int i = 0; i < current1.getNumClients(); i++) 
+    for (int i = 0; i < activeSolve->task.getNumClients(); i++) 
     {
         
         cout << setw(10) << left << ("C" + to_string(i + 1));
     }
     cout << endl;
-    cout << string(15 + current1.getNumClients() * 10, '-') << endl;
+    cout << string(15 + activeSolve->task.getNumClients() * 10, '-') << endl;
 
     // Print allocations for each server
-    for (int i = 0; i < current1.getNumServers(); i++) 
+    GeneLayout layout = geneLayout();
+    for (int i = 0; i < activeSolve->task.getNumServers(); i++) 
     {
         cout << setw(15) << left << ("Server " + to_string(i + 1));  // Server labels with extra space
-        for (int j = 0; j < current1.getNumClients(); j++) 
+        unsigned int k = layout.edgeStart[i];
+        for (int j = 0; j < activeSolve->task.getNumClients(); j++) 
         {
             // Print the allocation for each server-client pair
-            cout << setw(10) << left << individual.ServerAllocations[i][j];
+            if (k < layout.edgeStart[i + 1] && layout.client(i, k) == (unsigned int)j) {
+                cout << setw(10) << left << individual.ServerAllocations[k++];
+            } else {
+                cout << setw(10) << left << "-";
+            }
         }
         cout << endl;
     }
@@ -289,135 +578,1748 @@ void printIndividual(Chromosome& individual)
 }
 
 
-// Main genetic algorithm function
-// Time Complexity: O(G * (P * S * C)), where G is the number of generations, P is population size, S stands for server number, C stands for client number
-// Space Complexity: O(P * S * C).  P is population size, S stands for server number, C stands for client number
-void geneticAlgorithm(Task task1) {
-    srand(time(NULL));
-    current1 = task1;
-    findUpperBound(); // TC: O(C) C stands for clients
-    vector<Chromosome> parentPop = generateRandomPopulation();
-    evaluate(parentPop); // TC:O(P * S * C). P is population size, S stands for server number, C stands for client number
-
-    for (int i = 0; i < GENERATIONS; i++) {
-        vector<Chromosome> offspring = selection(parentPop); //TC: O(POP) POP stands for size of population
-        variation(offspring); //Time Complexity: O(POP * (S*C))
-        evaluate(offspring);
-        parentPop = survivor(offspring, parentPop); //  TC:O(P * S * C). P is population size, S stands for server number, C stands for client number
-
-        if(Verbose){
-            //Print the individual
-            cout << endl;
-            cout << "Generation " << i + 1 << " Current Best: " << endl;
-            printIndividual(parentPop[0]);
-            cout << "Fitness = " << parentPop[0].fitness << endl;
-            cout << "LatencyScore = " << parentPop[0].latencyScore << endl;
-            cout << "Penalty Capacity: " << parentPop[0].penaltyCapacity << endl;
-            cout << "Penalty Bandwith: " << parentPop[0].penaltyBandwith << endl;
-        }
-    }
-    // Print the best solution found
-    cout << "Best: " << endl;
-    printIndividual(parentPop[0]);
-    cout << "Fitness = " << parentPop[0].fitness << endl;
-}
-
-
-
-// Function to calculate the latency score for a chromosome
-// Time Complexity: O(S * C). S stands for server number, C stands for client number 
+// Function to calculate the latency score for a chromosome (scalar reference of the fitness kernels)
+// Objective: sum over all pairs of |bandwith * (1 / latency) - allocation * latencyTotal|,
+// rewritten as latencyTotal * |idealAllocation - allocation| with the tables frozen in the task,
+// so it is one streaming pass over the chromosome without divisions or bounds checks.
+// Time Complexity: O(S * C). S stands for server number, C stands for client number (O(E) reachable pairs if sparse)
 // Space Complexity: O(1) 
 void calculateLatencyScore(Chromosome& individual) {
+    const double* ideal = activeSolve->task.getIdealAllocations();
+    const double* latencyTotals = activeSolve->task.getLatencyTotals();
+    GeneLayout layout = geneLayout();
     double latencyScore = 0.0;
 
-    for (int i = 0; i < current1.getNumClients(); i++) {
-        double sum = 0.0;
-        double latencyTotal = 0.0;
-        for (int j = 0; j < current1.getNumServers(); j++) {
-            latencyTotal += (1.0 / current1.getLatency(j, i)); //Calculate the total latcen with reverse of respective latency matrix cell
-        }
-
-        for (int j = 0; j < current1.getNumServers(); j++) {
+    for (unsigned int j = 0; j < individual.numServers; j++) {
+        for (unsigned int k = layout.edgeStart[j]; k < layout.edgeStart[j + 1]; k++) {
             //This is the main objective function to minimize
-            latencyScore += abs(current1.getBandwith(i) * (1.0 / current1.getLatency(j, i)) - (individual.ServerAllocations[j][i] * latencyTotal));
+            latencyScore += latencyTotals[layout.client(j, k)] * abs(ideal[k] - individual.ServerAllocations[k]);
         }
     }
     individual.latencyScore = latencyScore; //assign the fitness to individual
 }
 
-//Penalty calculation (Constraints)
-// Time Complexity: O(S * C). S stands for server number, C stands for client number 
-// Space Complexity: O(1) 
+//Penalty calculation (Constraints), scalar reference of the fitness kernels
+// Time Complexity: O(S * C). S stands for server number, C stands for client number (O(S + C + E) if sparse)
+// Space Complexity: O(S + C) for the server and client sums
 void calculatePenalty(Chromosome& indi){
 
-    double capacityPen = 0;
-    double bandwithPen = 0;
-    double connectionPen = 0;
+    vector<double> serverSums(indi.numServers, 0.0);
+    vector<double> clientSums(indi.numClients, 0.0);
+    unsigned int zeroCount = 0;
+    GeneLayout layout = geneLayout();
 
-    for(int i = 0; i<current1.getNumServers(); i++){
-        unsigned int sum = 0;
-        for(int j = 0; j<current1.getNumClients(); j++){
-            if(indi.ServerAllocations[i][j] == 0){ //If serverAlloc is 0 assign connection penalty
-                connectionPen += PENALTY_CONSTANT;
+    for(unsigned int i = 0; i<indi.numServers; i++){
+        for(unsigned int k = layout.edgeStart[i]; k<layout.edgeStart[i + 1]; k++){
+            double gene = indi.ServerAllocations[k];
+            if(gene == 0){ //If serverAlloc is 0 assign connection penalty (only reachable pairs have a gene)
+                zeroCount++;
             }
-            sum += indi.ServerAllocations[i][j];
-        }
-        if(sum > current1.getCapacity(i)){ //If all the allocation sum greater than server capacity assign capacity penalty
-            capacityPen += (sum-current1.getCapacity(i))*PENALTY_CONSTANT;
+            serverSums[i] += gene;
+            clientSums[layout.client(i, k)] += gene;
         }
     }
-    
-    for(int i = 0; i<current1.getNumClients(); i++){
 
-        unsigned int sum = 0;
-        for(int j = 0; j<current1.getNumServers(); j++){
-            sum += indi.ServerAllocations[j][i];
+    penaltiesFromSums(indi, serverSums.data(), clientSums.data(), zeroCount);
+}
+
+// Turns the server loads, client allocations and zero genes of an individual into its penalties
+// Sums are kept as doubles so fractional allocations are not truncated before the comparison
+// Time Complexity: O(S + C). S stands for server number, C stands for client number 
+// Space Complexity: O(1) 
+void penaltiesFromSums(Chromosome& indi, const double* serverSums, const double* clientSums, unsigned int zeroCount){
+
+    double capacityPen = 0;
+    double bandwithPen = 0;
+    double connectionPen = zeroCount * (double)PENALTY_CONSTANT; //Every server with 0 allocation for a client adds connection penalty
+    unsigned int overloadedServers = 0;
+    unsigned int overloadedClients = 0;
+
+    for(unsigned int i = 0; i<indi.numServers; i++){
+        if(serverSums[i] > activeSolve->task.getCapacity(i)){ //If all the allocation sum greater than server capacity assign capacity penalty
+            capacityPen += (serverSums[i]-activeSolve->task.getCapacity(i))*PENALTY_CONSTANT;
+            overloadedServers++;
         }
-        if(sum > current1.getBandwith(i)){ //If all the allocation sum greater than server capacity assign capacity penalty
-            bandwithPen += (sum-current1.getBandwith(i)*PENALTY_CONSTANT);
+    }
+    
+    for(unsigned int i = 0; i<indi.numClients; i++){
+        if(clientSums[i] > activeSolve->task.getBandwith(i)){ //If all the allocation sum greater than client bandwith assign bandwith penalty
+            bandwithPen += (clientSums[i]-activeSolve->task.getBandwith(i))*PENALTY_CONSTANT;
+            overloadedClients++;
         }
     }
 
+    indi.zeroCount = zeroCount;
+    indi.overloadedServers = overloadedServers;
+    indi.overloadedClients = overloadedClients;
     indi.penaltyCapacity = capacityPen;
     indi.penaltyBandwith = bandwithPen;
     indi.connectionPen = connectionPen;
 }
 
+// Combines the latency score and the penalties of an individual into its fitness with the penalty policy
+// Time Complexity: O(1)
+// Space Complexity: O(1)
+template <class Penalty>
+void computeFitness(Chromosome& indi, const Penalty& penalty){
+    indi.modified = false;
+
+    // Compute the fitness score by combining latency score and penalties
+    indi.fitness = penalty.fitness(indi);
+
+    // Check if the chromosome is feasible (if there is no penalties)
+    // The violation counters are exact even when the penalties were updated incrementally
+    if(indi.overloadedServers + indi.overloadedClients + indi.zeroCount == 0) {
+        indi.isFeas = true;
+    } else {
+        indi.isFeas = false;
+    }
+}
+
+// Evaluates the latency score and penalties of one individual from scratch with the selected fitness kernel
+// The server and client loads are written into the individual's cache, which becomes valid.
+// The fitness itself is combined afterwards by computeFitness() with the penalty policy of the run.
+// Time Complexity: O(S * C), a single pass over the chromosome (O(S + C + E) if sparse)
+// Space Complexity: O(1) 
+void evaluateIndividual(Chromosome& indi){
+    unsigned int zeroCount = 0;
+    if(activeSolve->task.isSparse()){
+        fitnessKernelSparse(indi.ServerAllocations, activeSolve->task.getIdealAllocations(), activeSolve->task.getLatencyTotals(),
+                            indi.numServers, indi.numClients, activeSolve->task.getEdgeStart(), activeSolve->task.getEdgeClients(),
+                            indi.serverLoads, indi.clientLoads, &indi.latencyScore, &zeroCount);
+    } else {
+        fitnessKernel(indi.ServerAllocations, activeSolve->task.getIdealAllocations(), activeSolve->task.getLatencyTotals(),
+                      indi.numServers, indi.numClients, indi.serverLoads, indi.clientLoads, &indi.latencyScore, &zeroCount);
+    }
+    penaltiesFromSums(indi, indi.serverLoads, indi.clientLoads, zeroCount);
+    indi.cacheValid = true;
+    indi.deltaUpdates = 0;
+}
+
+// Changes one gene (index `index`, pair server-client) to value rounded by toGene() and, if the individual has a valid cache,
+// updates its latency score, loads and penalties by the contribution of that gene only.
+// Rounding drift of these updates is flushed by the periodic full evaluation.
+// Time Complexity: O(1)
+// Space Complexity: O(1) 
+void updateGene(Chromosome& indi, unsigned int index, unsigned int server, unsigned int client, double value){
+    Gene& gene = indi.ServerAllocations[index];
+    double old = gene;
+    value = toGene(value); // The deltas below use the stored (rounded) value
+    if(old == value){
+        return; // Nothing changes, the individual stays clean
+    }
+    gene = value;
+    indi.modified = true;
+    if(!indi.cacheValid){
+        return;
+    }
+    indi.deltaUpdates++;
+
+    // Latency score: swap the old contribution of the gene for the new one
+    double ideal = activeSolve->task.getIdealAllocations()[index];
+    double latencyTotal = activeSolve->task.getLatencyTotals()[client];
+    indi.latencyScore += latencyTotal * (abs(ideal - value) - abs(ideal - old));
+
+    // Capacity penalty of the server
+    double capacity = activeSolve->task.getCapacity(server);
+    double excessBefore = indi.serverLoads[server] - capacity;
+    indi.serverLoads[server] += value - old;
+    double excessAfter = indi.serverLoads[server] - capacity;
+    indi.overloadedServers += (excessAfter > 0) - (excessBefore > 0);
+    indi.penaltyCapacity += (max(excessAfter, 0.0) - max(excessBefore, 0.0)) * PENALTY_CONSTANT;
+    if(indi.overloadedServers == 0){
+        indi.penaltyCapacity = 0; // Exact zero, whatever rounding accumulated
+    }
+
+    // Bandwith penalty of the client
+    double bandwith = activeSolve->task.getBandwith(client);
+    excessBefore = indi.clientLoads[client] - bandwith;
+    indi.clientLoads[client] += value - old;
+    excessAfter = indi.clientLoads[client] - bandwith;
+    indi.overloadedClients += (excessAfter > 0) - (excessBefore > 0);
+    indi.penaltyBandwith += (max(excessAfter, 0.0) - max(excessBefore, 0.0)) * PENALTY_CONSTANT;
+    if(indi.overloadedClients == 0){
+        indi.penaltyBandwith = 0;
+    }
+
+    // Connection penalty
+    indi.zeroCount += (value == 0) - (old == 0);
+    indi.connectionPen = indi.zeroCount * (double)PENALTY_CONSTANT;
+}
+
+// True if an individual has to go through the fitness kernel in this evaluation pass:
+// it was never evaluated, or this is a full pass and incremental updates may have drifted
+// Time Complexity: O(1)
+// Space Complexity: O(1)
+bool needsFullEvaluation(const Chromosome& indi, bool fullEvaluation){
+    return !indi.cacheValid || (fullEvaluation && indi.deltaUpdates > 0);
+}
+
 //Evaluation Phase of the genetic algorithm
-// Time Comp: O(POP* (S*C)), POP stands for population size, S stands for server number, C stands for client number 
-// Space Comp: O(1) every elements are passed by reference
-void evaluate(vector<Chromosome>& pop)
+// - Unmodified individuals (copied unchanged by selection) keep their fitness and are skipped.
+// - Individuals whose cache was kept up to date by updateGene() only need their fitness recombined.
+// - The others, and the drifted ones when fullEvaluation is true, go through the fitness kernel.
+//   With FITNESS_MEMO, identical individuals among them are evaluated once and share the result.
+// Individuals are evaluated independently, so the population is split over the pool when one is given
+// profiler: counts the kernel passes, memo hits and recombinations, null -> not counted
+// Time Comp: O(POP* (S*C) / T) for a full pass, O(POP / T) when every cache is valid.
+//            POP stands for population size, S stands for server number, C stands for client number, T stands for threads
+// Space Comp: O(1), the memo lives in the population's scratch buffers
+template <class Penalty>
+void evaluate(Population& pop, const Penalty& penalty, ThreadPool* pool, bool fullEvaluation, Profiler* profiler)
 {
-    // Iterate through the entire population
-    for(int i = 0; i < POPULATION; i++) 
-    {
-        // Calculate the latency score for the current chromosome
-        calculateLatencyScore(pop[i]); 
+    // memoSource[i] != i means individual i is a duplicate of memoSource[i] and copies its evaluation
+    vector<unsigned int>& memoSource = pop.memoSource;
+    memoSource.clear();
+    if(FITNESS_MEMO){
+        memoSource.resize(pop.size());
+        vector<pair<uint64_t, unsigned int>>& memoKeys = pop.memoKeys;
+        memoKeys.resize(pop.size());
+        auto hashRange = [&pop, &memoKeys, &memoSource, fullEvaluation](size_t begin, size_t end) {
+            for(size_t i = begin; i < end; i++){
+                memoSource[i] = i;
+                // Individuals that skip the kernel get a sentinel key and are ignored below
+                memoKeys[i].first = needsFullEvaluation(pop[i], fullEvaluation) ? hashGenes(pop[i]) : 0;
+                memoKeys[i].second = i;
+            }
+        };
+        if (pool) {
+            parallelSolve(*pool, pop.size(), hashRange);
+        } else {
+            hashRange(0, pop.size());
+        }
+
+        // Equal hashes end up next to each other, the lowest index of each group is evaluated
+        sort(memoKeys.begin(), memoKeys.end()); // O(POP * log(POP))
+        for(size_t k = 1; k < memoKeys.size(); k++){
+            unsigned int first = memoSource[memoKeys[k - 1].second];
+            unsigned int current = memoKeys[k].second;
+            if(memoKeys[k].first == memoKeys[k - 1].first && needsFullEvaluation(pop[current], fullEvaluation)
+               && needsFullEvaluation(pop[first], fullEvaluation) && sameGenes(pop[first], pop[current])){
+                memoSource[current] = first;
+            }
+        }
+    }
 
-        // Calculate the penalty values
-        calculatePenalty(pop[i]); 
+    auto evaluateRange = [&pop, &penalty, &memoSource, fullEvaluation, profiler](size_t begin, size_t end) {
+        unsigned long long kernelPasses = 0, recombined = 0;
+        for(size_t i = begin; i < end; i++) 
+        {
+            if(needsFullEvaluation(pop[i], fullEvaluation)){
+                if(memoSource.empty() || memoSource[i] == i){
+                    // Latency score and penalties in one pass of the fitness kernel
+                    evaluateIndividual(pop[i]);
+                    computeFitness(pop[i], penalty);
+                    kernelPasses++;
+                }
+            } else if(pop[i].modified){
+                computeFitness(pop[i], penalty); // Scores and penalties are already up to date
+                recombined++;
+            }
+        }
+        if(PROFILING && profiler){
+            profiler->count(PROFILE_KERNEL_EVALUATIONS, kernelPasses); // One atomic add per range
+            profiler->count(PROFILE_RECOMBINED, recombined);
+        }
+    };
 
-        // Compute the fitness score by combining latency score and penalties
-        pop[i].fitness = pop[i].latencyScore + PENALTY_CONSTANT * (pop[i].penaltyCapacity + pop[i].penaltyBandwith + pop[i].connectionPen);
+    if (pool) {
+        parallelSolve(*pool, pop.size(), evaluateRange);
+    } else {
+        evaluateRange(0, pop.size());
+    }
 
-        // Check if the chromosome is feasible (if there is no penalties)
-        if(pop[i].penaltyCapacity + pop[i].penaltyBandwith + pop[i].connectionPen == 0) {
-            pop[i].isFeas = true;
-        } else {
-            pop[i].isFeas = false;
+    // Duplicates take the evaluation of the individual they are identical to
+    unsigned long long memoHits = 0;
+    for(size_t i = 0; i < memoSource.size(); i++){
+        if(memoSource[i] != i){
+            pop[i].copyFrom(pop[memoSource[i]]);
+            memoHits++;
         }
     }
+    if(PROFILING && profiler){
+        profiler->count(PROFILE_MEMO_HITS, memoHits);
+    }
 }
 
 
 //Finds upper bounds for each clients
+//Bounds above the largest gene (uint16 genes) are capped to it with a message
 //Time Complexity: O(C) C stands for number of clients
-//Space Complexity: O(C) it adds c elements to upperBounds vector
+//Space Complexity: O(C) it adds c elements to the upperBounds vector of the current solve
 void findUpperBound(){
-    for(int i = 0; i<current1.getNumClients(); i++){
+    Task& task = activeSolve->task;
+    vector<unsigned int>& upperBounds = activeSolve->upperBounds;
+    upperBounds.clear(); // Bounds of a previous run must not leak into this one
+    unsigned int capped = 0;
+    for(int i = 0; i<task.getNumClients(); i++){
         upperBounds.push_back(0);
-        if(current1.getBandwith(i) > upperBounds[i]){
-            upperBounds[i] = current1.getBandwith(i);
+        if(task.getBandwith(i) > upperBounds[i]){
+            upperBounds[i] = task.getBandwith(i);
+        }
+        if(upperBounds[i] > geneMaximum){
+            upperBounds[i] = (unsigned int)min<double>(upperBounds[i], geneMaximum);
+            capped++;
+        }
+    }
+    if(capped){
+        cout << capped << " client bandwidths exceed the largest gene (" << geneMaximum << "), their allocations are capped" << endl;
+    }
+}
+// Operator policies
+// Each policy is a type with static functions, the engine below calls them directly so the
+// compiler sees the operator it is running and no method check is left in the gene loops.
+
+// Binary tournament selection (SELECTION_METHOD 1)
+struct BinaryTournamentSelection
+{
+    static void select(const Population& pop, vector<unsigned int>& matingPool, const RandomStreams& streams, unsigned int generation); // Fills matingPool with winner indices.
+};
+
+// BLX-alpha crossover (CROSSOVER_METHOD 1): generates offspring by blending values with a factor determined by alpha
+struct BlxAlphaCrossover
+{
+    static void apply(Chromosome& off1, Chromosome& off2, Rng& rng); // Crosses every gene of a pair.
+    static double blend(double p1, double p2, unsigned int client, Rng& rng); // One blended value.
+};
+
+// SBX crossover (CROSSOVER_METHOD 2): mimics binary crossover in continuous search spaces
+struct SbxCrossover
+{
+    static void apply(Chromosome& off1, Chromosome& off2, Rng& rng); // Crosses every gene of a pair.
+    static void crossGene(Chromosome& off1, Chromosome& off2, unsigned int index, unsigned int server, unsigned int client, Rng& rng); // Crosses one gene.
+};
+
+// Random mutation (MUTATION_METHOD 1)
+struct RandomMutation
+{
+    static void apply(Chromosome& off1, Rng& rng); // Mutates a chromosome.
+};
+
+// Elitist survivor selection (ELITISM true -> elitist_full)
+struct ElitistSurvivor
+{
+    static void apply(Population& offspring, Population& parentPop, vector<unsigned int>& order, ThreadPool* pool = nullptr); // Best POP of parents + offspring.
+};
+
+// Generational survivor selection (ELITISM false -> non_elitist)
+struct GenerationalSurvivor
+{
+    static void apply(Population& offspring, Population& parentPop, vector<unsigned int>& order, ThreadPool* pool = nullptr); // Offspring replace the parents.
+};
+
+// Crowded tournament selection (multi-objective mode): lower rank wins, then larger crowding distance
+struct CrowdedTournamentSelection
+{
+    static void select(const Population& pop, vector<unsigned int>& matingPool, const RandomStreams& streams, unsigned int generation); // Fills matingPool with winner indices.
+};
+
+// NSGA-II survivor selection (multi-objective mode): parents + offspring are sorted into non-dominated
+// fronts, whole fronts are kept while they fit and the last one is cut by crowding distance.
+// Sets rank and crowding of every survivor. The best fitness is still moved to slot 0 for the logs.
+struct NsgaSurvivor
+{
+    static void apply(Population& offspring, Population& parentPop, vector<unsigned int>& order, ThreadPool* pool = nullptr); // Best fronts of parents + offspring.
+};
+
+// Static penalty (PENALTY_METHOD 1)
+// Penalty policies are instances: update() is called before each generation and may adapt the
+// policy to the current population, fitness() combines the scores of one individual.
+// The penalties of an individual already include PENALTY_CONSTANT, a policy only weights them.
+// update() returns true when the weight changed, the engine then recombines the fitness of the parents.
+struct StaticPenalty
+{
+    bool update(const Population& pop, unsigned int generation); // Nothing to adapt.
+    double fitness(const Chromosome& indi) const; // Latency score plus the penalties.
+};
+
+// Generation-scheduled penalty (PENALTY_METHOD 2): the weight grows as (C * generation)^ALPHA, so
+// early generations explore through infeasible regions and late ones are pushed onto the constraints
+struct ScheduledPenalty
+{
+    double weight = PENALTY_WEIGHT_MIN;
+
+    bool update(const Population& pop, unsigned int generation); // Weight of the generation.
+    double fitness(const Chromosome& indi) const; // Latency score plus the weighted penalties.
+};
+
+// Adaptive penalty (PENALTY_METHOD 3): the weight grows while fewer than PENALTY_TARGET_FEASIBLE of
+// the population are feasible and shrinks while more are, so it settles where the latency and the
+// penalties are of comparable scale whatever the scale of the instance
+struct AdaptivePenalty
+{
+    double weight = 1;
+
+    bool update(const Population& pop, unsigned int generation); // Feedback from the feasible ratio.
+    double fitness(const Chromosome& indi) const; // Latency score plus the weighted penalties.
+};
+
+// Moves the best individual of a population to slot 0, only views are swapped
+// Time Comp: O(POP)
+// Space Comp: O(1)
+void moveBestFirst(Population& pop)
+{
+    unsigned int best = 0;
+    for (unsigned int k = 1; k < pop.size(); k++) {
+        if (pop[k].fitness < pop[best].fitness) {
+            best = k;
+        }
+    }
+    swap(pop.individuals[0], pop.individuals[best]);
+}
+
+// Tournament selection
+// Fills matingPool with the index of the winner of each tournament, no chromosome is copied.
+// Tournament i draws from its own stream of the given generation
+// Time Complexity: O(POP) POP stands for size of population
+// Space Complexity: O(1) matingPool is reused from one generation to the next
+void BinaryTournamentSelection::select(const Population& pop, vector<unsigned int>& matingPool, const RandomStreams& streams, unsigned int generation)
+{
+    matingPool.resize(pop.size());
+    for (unsigned int i = 0; i < pop.size(); i++) {
+        Rng rng = streams.stream(PHASE_SELECTION, generation, i);
+
+        // Select two random chromosomes and pick the one with better fitness
+        unsigned int index1 = rng.bounded(pop.size());
+        unsigned int index2 = rng.bounded(pop.size());
+        matingPool[i] = pop[index1].fitness < pop[index2].fitness ? index1 : index2;
+    }
+}
+
+// BLX-alpha crossover of every server and client combination
+// Time Comp: O(S*C) S stands for server number, C stands for client number (O(E) reachable pairs if sparse)
+// Space Comp: O(1) all the things passed by reference
+void BlxAlphaCrossover::apply(Chromosome& off1, Chromosome& off2, Rng& rng)
+{
+    GeneLayout layout = geneLayout();
+    for (unsigned int i = 0; i < off1.numServers; i++) {
+        for (unsigned int k = layout.edgeStart[i]; k < layout.edgeStart[i + 1]; k++) {
+            unsigned int j = layout.client(i, k);
+
+            // Generate two new values for offspring using the BLX-alpha method
+            double newVal1 = blend(off1.ServerAllocations[k], off2.ServerAllocations[k], j, rng);
+            double newVal2 = blend(off1.ServerAllocations[k], off2.ServerAllocations[k], j, rng);
+            // Assign the new values to the offspring
+            updateGene(off1, k, i, j, newVal1);
+            updateGene(off2, k, i, j, newVal2);
         }
     }
-}
\ No newline at end of file
+}
+
+// BLX-alpha blend of two parent values
+// Time Complexity: O(1)
+// Space Complexity: O(1)
+double BlxAlphaCrossover::blend(double p1, double p2, unsigned int client, Rng& rng)
+{
+    double minVal = min(p1, p2); //Find the min one
+    double maxVal = max(p1, p2); //Find the max one
+    double u = rng.uniform(); //generate random number between 0 to 1
+    double gamma = ((1.0 + 2.0 * CROSSOVER_ALPHA) * u) - CROSSOVER_ALPHA; //gamma formulation
+    double off = ((1.0 - gamma) * minVal) + (gamma * maxVal); //find new offspring values
+    off = max(min(off, (double)activeSolve->upperBounds[client]), 0.0); //bound check
+    return off;
+}
+
+// SBX crossover of every server and client combination
+// Time Comp: O(S*C) S stands for server number, C stands for client number (O(E) reachable pairs if sparse)
+// Space Comp: O(1) all the things passed by reference
+void SbxCrossover::apply(Chromosome& off1, Chromosome& off2, Rng& rng)
+{
+    GeneLayout layout = geneLayout();
+    for (unsigned int i = 0; i < off1.numServers; i++) {
+        for (unsigned int k = layout.edgeStart[i]; k < layout.edgeStart[i + 1]; k++) {
+            unsigned int j = layout.client(i, k);
+
+            // Apply SBX crossover
+            crossGene(off1, off2, k, i, j, rng);
+            crossGene(off1, off2, k, i, j, rng);
+        }
+    }
+}
+
+// SBX crossover of one gene
+// Time Complexity: O(1)
+// Space Complexity: O(1)
+void SbxCrossover::crossGene(Chromosome& off1, Chromosome& off2, unsigned int index, unsigned int server, unsigned int client, Rng& rng)
+{
+    double x1 = off1.ServerAllocations[index];
+    double x2 = off2.ServerAllocations[index];
+
+    double k = rng.uniform(); // Generate random value [0, 1)
+    double beta;
+
+    if (k <= 0.5) {
+        beta = pow(2 * k, 1.0 / (CROSSOVER_ETA + 1));
+    } else {
+        beta = pow(1.0 / (2 * (1 - k)), 1.0 / (CROSSOVER_ETA + 1));
+    }
+
+    //Formulation of SBX crossover
+    double y1 = 0.5 * ((1 + beta) * x1 + (1 - beta) * x2); 
+    double y2 = 0.5 * ((1 - beta) * x1 + (1 + beta) * x2);
+
+    // Clamp values to valid bounds
+    y1 = max(min(y1, (double)activeSolve->upperBounds[client]), 0.0);
+    y2 = max(min(y2, (double)activeSolve->upperBounds[client]), 0.0);
+
+    //Assigns new values to proper genes
+    updateGene(off1, index, server, client, y1);
+    updateGene(off2, index, server, client, y2);
+}
+
+// Random mutation of a chromosome
+// Time Complexity: O(S*C) C stands for number of server, C stands for number of clients (O(E) reachable pairs if sparse)
+// Space Complexity: O(1) constant
+void RandomMutation::apply(Chromosome& off1, Rng& rng)
+{
+    GeneLayout layout = geneLayout();
+    for (unsigned int i = 0; i < off1.numServers; i++) {
+        for (unsigned int k = layout.edgeStart[i]; k < layout.edgeStart[i + 1]; k++) {
+            unsigned int j = layout.client(i, k);
+
+            // Randomly mutate gene based on a 50% probability
+            if (rng.coin()) {
+                updateGene(off1, k, i, j, rng.bounded(activeSolve->upperBounds[j]));
+            }
+        }
+    }
+}
+
+// Elitist survivor selection
+// The best POP of parents + offspring are picked with nth_element over indices, then the winning
+// offspring are copied into the slots of the losing parents. parentPop holds the next generation,
+// its best individual first. Nothing is allocated once order has reached 2 * POP entries.
+// Time Comp: O(POP + K * S * C), K stands for the number of offspring that beat a parent
+// Space Comp: O(1), order is a scratch buffer owned by the caller
+void ElitistSurvivor::apply(Population& offspring, Population& parentPop, vector<unsigned int>& order, ThreadPool*)
+{
+    // Indices below parentSize are parents, the others offspring
+    unsigned int parentSize = parentPop.size();
+    order.resize(parentSize + offspring.size());
+    for (unsigned int k = 0; k < order.size(); k++) {
+        order[k] = k;
+    }
+    auto fitnessOf = [&](unsigned int k) {
+        return k < parentSize ? parentPop[k].fitness : offspring[k - parentSize].fitness;
+    };
+    nth_element(order.begin(), order.begin() + parentSize, order.end(),
+                [&](unsigned int a, unsigned int b) { return fitnessOf(a) < fitnessOf(b); }); // O(POP) on average
+
+    // Each offspring among the winners takes the slot of a parent among the losers (same count)
+    unsigned int loser = parentSize;
+    for (unsigned int k = 0; k < parentSize; k++) {
+        if (order[k] < parentSize) {
+            continue;
+        }
+        while (order[loser] >= parentSize) {
+            loser++;
+        }
+        parentPop[order[loser++]].copyFrom(offspring[order[k] - parentSize]);
+    }
+    moveBestFirst(parentPop);
+}
+
+// Generational survivor selection
+// The two buffers are swapped, the old parents become the buffer the next generation is bred into
+// Time Comp: O(POP)
+// Space Comp: O(1)
+void GenerationalSurvivor::apply(Population& offspring, Population& parentPop, vector<unsigned int>&, ThreadPool*)
+{
+    swap(offspring, parentPop);
+    moveBestFirst(parentPop);
+}
+
+// Multi-objective mode
+
+// Load imbalance: standard deviation of the server utilizations (load / capacity)
+// Needs the cached server loads, which every evaluated individual has.
+// Time Comp: O(S)
+// Space Comp: O(1)
+double loadImbalance(const Chromosome& indi)
+{
+    double sum = 0, squares = 0;
+    for (unsigned int i = 0; i < indi.numServers; i++) {
+        double utilization = indi.serverLoads[i] / max(1u, activeSolve->task.getCapacity(i));
+        sum += utilization;
+        squares += utilization * utilization;
+    }
+    double mean = sum / indi.numServers;
+    return sqrt(max(squares / indi.numServers - mean * mean, 0.0));
+}
+
+// Objectives of an evaluated individual, all minimized: latency score, load imbalance and violation
+// (capacity, bandwidth and connection penalties before the fitness weighting)
+// Time Comp: O(S)
+// Space Comp: O(1)
+void objectiveValues(const Chromosome& indi, double* objectives)
+{
+    objectives[0] = indi.latencyScore;
+    objectives[1] = loadImbalance(indi);
+    objectives[2] = indi.penaltyCapacity + indi.penaltyBandwith + indi.connectionPen;
+}
+
+// Pareto dominance of two objective vectors: 1 -> a dominates b, -1 -> b dominates a, 0 -> neither
+// Time Comp: O(M), M stands for OBJECTIVES
+// Space Comp: O(1)
+int dominance(const double* a, const double* b)
+{
+    bool aBetter = false, bBetter = false;
+    for (unsigned int m = 0; m < OBJECTIVES; m++) {
+        aBetter |= a[m] < b[m];
+        bBetter |= b[m] < a[m];
+    }
+    return aBetter == bBetter ? 0 : aBetter ? 1 : -1;
+}
+
+// Fast non-dominated sort (Deb et al.) of N objective vectors, ranks[i] receives the front of vector i
+// Row i of the dominance bit matrix marks the vectors i dominates, count[i] how many dominate i.
+// Rows are independent, so they are spread over the pool, peeling the fronts is serial.
+// Time Comp: O(M * N^2 / T + N^2 / 64)
+// Space Comp: O(1), dominanceBits and count are scratch buffers of the caller
+void nonDominatedSort(const vector<double>& objectives, unsigned int n, vector<unsigned int>& ranks,
+                      vector<uint64_t>& dominanceBits, vector<unsigned int>& count, vector<unsigned int>& front,
+                      ThreadPool* pool)
+{
+    size_t words = (n + 63) / 64;
+    dominanceBits.assign(words * n, 0);
+    count.assign(n, 0);
+    ranks.assign(n, 0);
+    auto compareRows = [&objectives, &dominanceBits, &count, n, words](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            uint64_t* row = dominanceBits.data() + i * words;
+            for (unsigned int j = 0; j < n; j++) {
+                int relation = dominance(&objectives[i * OBJECTIVES], &objectives[j * OBJECTIVES]);
+                if (relation > 0) {
+                    row[j / 64] |= 1ULL << (j % 64);
+                } else if (relation < 0) {
+                    count[i]++;
+                }
+            }
+        }
+    };
+    if (pool) {
+        parallelSolve(*pool, n, compareRows);
+    } else {
+        compareRows(0, n);
+    }
+
+    // front holds the current front, the next one is appended behind it
+    front.clear();
+    for (unsigned int i = 0; i < n; i++) {
+        if (count[i] == 0) {
+            front.push_back(i);
+        }
+    }
+    size_t begin = 0;
+    for (unsigned int rank = 0; begin < front.size(); rank++) {
+        size_t end = front.size();
+        for (size_t f = begin; f < end; f++) {
+            unsigned int i = front[f];
+            ranks[i] = rank;
+            const uint64_t* row = dominanceBits.data() + i * words;
+            for (size_t w = 0; w < words; w++) {
+                for (uint64_t bits = row[w]; bits; bits &= bits - 1) {
+                    unsigned int j = w * 64 + __builtin_ctzll(bits);
+                    if (--count[j] == 0) {
+                        front.push_back(j);
+                    }
+                }
+            }
+        }
+        begin = end;
+    }
+}
+
+// Crowding distance of the members of one front: for every objective, the normalized distance
+// between the two neighbours of a member, the extremes get INFINITY
+// Time Comp: O(M * F log F), F stands for the front size
+// Space Comp: O(1), members is reordered in place
+void crowdingDistance(const vector<double>& objectives, unsigned int* members, size_t size, vector<double>& crowding)
+{
+    for (size_t f = 0; f < size; f++) {
+        crowding[members[f]] = 0;
+    }
+    if (size < 3) {
+        for (size_t f = 0; f < size; f++) {
+            crowding[members[f]] = INFINITY;
+        }
+        return;
+    }
+    for (unsigned int m = 0; m < OBJECTIVES; m++) {
+        sort(members, members + size, [&objectives, m](unsigned int a, unsigned int b) {
+            double ua = objectives[a * OBJECTIVES + m], ub = objectives[b * OBJECTIVES + m];
+            return ua < ub || (ua == ub && a < b); // Ties by index, the result does not depend on the sort
+        });
+        double low = objectives[members[0] * OBJECTIVES + m];
+        double range = objectives[members[size - 1] * OBJECTIVES + m] - low;
+        crowding[members[0]] = INFINITY;
+        crowding[members[size - 1]] = INFINITY;
+        if (!(range > 0) || std::isinf(range)) {
+            continue;
+        }
+        for (size_t f = 1; f + 1 < size; f++) {
+            crowding[members[f]] += (objectives[members[f + 1] * OBJECTIVES + m] - objectives[members[f - 1] * OBJECTIVES + m]) / range;
+        }
+    }
+}
+
+// Crowded tournament, the fitness breaks the remaining ties (the initial population has no ranks yet)
+// Tournament i draws from its own stream of the given generation
+// Time Complexity: O(POP)
+// Space Complexity: O(1)
+void CrowdedTournamentSelection::select(const Population& pop, vector<unsigned int>& matingPool, const RandomStreams& streams, unsigned int generation)
+{
+    matingPool.resize(pop.size());
+    for (unsigned int i = 0; i < pop.size(); i++) {
+        Rng rng = streams.stream(PHASE_SELECTION, generation, i);
+        unsigned int index1 = rng.bounded(pop.size());
+        unsigned int index2 = rng.bounded(pop.size());
+        const Chromosome& a = pop[index1];
+        const Chromosome& b = pop[index2];
+        bool secondWins = b.rank < a.rank
+                          || (b.rank == a.rank && (b.crowding > a.crowding || (b.crowding == a.crowding && b.fitness < a.fitness)));
+        matingPool[i] = secondWins ? index2 : index1;
+    }
+}
+
+// NSGA-II survivor selection over the union of parents (indices below POP) and offspring
+// The buffers live in thread-local storage (one set per island thread), so nothing is allocated
+// once they reached the size of the union.
+// Time Comp: O(M * N^2 / T + N^2 / 64 + M * N log N + K * S * C), N = 2 * POP, K offspring that replace parents
+// Space Comp: O(N^2 / 64) for the dominance bits
+void NsgaSurvivor::apply(Population& offspring, Population& parentPop, vector<unsigned int>& order, ThreadPool* pool)
+{
+    struct Scratch
+    {
+        vector<double> objectives;
+        vector<uint64_t> dominanceBits;
+        vector<unsigned int> count;
+        vector<unsigned int> ranks;
+        vector<double> crowding;
+    };
+    static thread_local Scratch scratch;
+
+    unsigned int parentSize = parentPop.size();
+    unsigned int n = parentSize + offspring.size();
+    auto member = [&](unsigned int k) -> Chromosome& {
+        return k < parentSize ? parentPop[k] : offspring[k - parentSize];
+    };
+    scratch.objectives.resize((size_t)n * OBJECTIVES);
+    for (unsigned int k = 0; k < n; k++) {
+        objectiveValues(member(k), &scratch.objectives[(size_t)k * OBJECTIVES]);
+    }
+
+    // order lists the union front by front, each front is then sorted by decreasing crowding
+    nonDominatedSort(scratch.objectives, n, scratch.ranks, scratch.dominanceBits, scratch.count, order, pool);
+    scratch.crowding.resize(n);
+    for (size_t begin = 0; begin < n;) {
+        size_t end = begin;
+        while (end < n && scratch.ranks[order[end]] == scratch.ranks[order[begin]]) {
+            end++;
+        }
+        crowdingDistance(scratch.objectives, order.data() + begin, end - begin, scratch.crowding);
+        const vector<double>& crowding = scratch.crowding;
+        sort(order.begin() + begin, order.begin() + end, [&crowding](unsigned int a, unsigned int b) {
+            return crowding[a] > crowding[b] || (crowding[a] == crowding[b] && a < b);
+        });
+        begin = end;
+    }
+    for (unsigned int k = 0; k < n; k++) {
+        member(k).rank = scratch.ranks[k];
+        member(k).crowding = scratch.crowding[k];
+    }
+
+    // The first parentSize entries of order survive, winning offspring take the slots of losing parents
+    unsigned int loser = parentSize;
+    for (unsigned int k = 0; k < parentSize; k++) {
+        if (order[k] < parentSize) {
+            continue;
+        }
+        while (order[loser] >= parentSize) {
+            loser++;
+        }
+        parentPop[order[loser++]].copyFrom(offspring[order[k] - parentSize]);
+    }
+    moveBestFirst(parentPop);
+}
+
+// Time Comp: O(1)
+// Space Comp: O(1)
+bool StaticPenalty::update(const Population&, unsigned int)
+{
+    return false;
+}
+
+// Fitness = latency score + capacity + bandwidth + connection penalties
+// Time Comp: O(1)
+// Space Comp: O(1)
+double StaticPenalty::fitness(const Chromosome& indi) const
+{
+    return indi.latencyScore + indi.penaltyCapacity + indi.penaltyBandwith + indi.connectionPen;
+}
+
+// Time Comp: O(1)
+// Space Comp: O(1)
+bool ScheduledPenalty::update(const Population&, unsigned int generation)
+{
+    double previous = weight;
+    weight = min(max(pow(PENALTY_SCHEDULE_C * generation, (double)PENALTY_SCHEDULE_ALPHA), (double)PENALTY_WEIGHT_MIN), (double)PENALTY_WEIGHT_MAX);
+    return weight != previous;
+}
+
+// Time Comp: O(1)
+// Space Comp: O(1)
+double ScheduledPenalty::fitness(const Chromosome& indi) const
+{
+    return indi.latencyScore + weight * (indi.penaltyCapacity + indi.penaltyBandwith + indi.connectionPen);
+}
+
+// Time Comp: O(POP)
+// Space Comp: O(1)
+bool AdaptivePenalty::update(const Population& pop, unsigned int)
+{
+    unsigned int feasible = 0;
+    for (const Chromosome& individual : pop.individuals) {
+        feasible += individual.isFeas;
+    }
+    double previous = weight;
+    if (feasible < PENALTY_TARGET_FEASIBLE * pop.size()) {
+        weight = min(weight * PENALTY_ADAPT_RATE, (double)PENALTY_WEIGHT_MAX);
+    } else {
+        weight = max(weight / PENALTY_ADAPT_RATE, (double)PENALTY_WEIGHT_MIN);
+    }
+    return weight != previous;
+}
+
+// Time Comp: O(1)
+// Space Comp: O(1)
+double AdaptivePenalty::fitness(const Chromosome& indi) const
+{
+    return indi.latencyScore + weight * (indi.penaltyCapacity + indi.penaltyBandwith + indi.connectionPen);
+}
+
+// Optional memetic steps of the engine, applied around the operator pipeline of each generation
+struct MemeticOptions
+{
+    bool repairOffspring = REPAIR_OFFSPRING; // Repair infeasible offspring before survivor selection
+    unsigned int localSearchElites = LOCAL_SEARCH_ELITES; // 0 -> no local search
+    unsigned int localSearchSteps = LOCAL_SEARCH_STEPS; // Moves tried on each elite per generation
+};
+
+// Genetic algorithm engine, one instantiation per combination of operators
+// It owns the double-buffered generations and the scratch buffers, so step() never allocates.
+// The solve context (frozen task and upperBounds) and the fitness kernel must be set up before it is constructed.
+template <class Selection, class Crossover, class Mutation, class Survivor, class Penalty>
+class GeneticAlgorithm
+{
+    private:
+    RandomStreams streams; // Every random draw of the run derives from these
+    ThreadPool* pool; // Workers for evaluation and variation, null -> serial
+    unsigned int populationSize; // Individuals per generation
+    Penalty penalty; // Penalty policy, may adapt from one generation to the next
+    Population parentPop; // Current generation
+    Population offspring; // Buffer the next generation is bred into
+    vector<unsigned int> matingPool; // Winner indices of the selection
+    vector<unsigned int> survivorOrder; // Scratch buffer of the survivor selection
+    MemeticOptions memetic; // Repair and local search settings
+    Profiler* profiler; // Phase timers and counters, null -> not profiled
+
+    void variation(unsigned int generation); // Crossover and mutation of the offspring pairs.
+    void repairOffspring(); // Repairs and re-evaluates the infeasible offspring.
+    void localSearch(unsigned int generation); // Polishes the elites of the current generation.
+
+    public:
+    GeneticAlgorithm(const RandomStreams& streams, ThreadPool* pool = nullptr, unsigned int populationSize = POPULATION); // Constructor.
+
+    // Methods
+    void initialize(double seedFraction = 0); // Random initial population (seedFraction of it heuristic), fully evaluated.
+    void initialize(Population start); // Starts from a given population (e.g. a warm start), fully evaluated.
+    void setMemetic(const MemeticOptions& options); // Enables repair and local search for the next generations.
+    void setProfiler(Profiler* profiler); // Times the phases of the next generations, null -> off.
+    void step(unsigned int generation); // Runs one generation.
+    void evaluateOne(Chromosome& individual) const; // Full evaluation of one individual, e.g. an immigrant.
+    Population& getPopulation(); // Current generation.
+    Chromosome& best(); // Best individual of the current generation.
+};
+
+// Constructor
+// Time Complexity: O(1)
+// Space Complexity: O(1)
+template <class Selection, class Crossover, class Mutation, class Survivor, class Penalty>
+GeneticAlgorithm<Selection, Crossover, Mutation, Survivor, Penalty>::GeneticAlgorithm(const RandomStreams& streams, ThreadPool* pool, unsigned int populationSize)
+    : streams(streams)
+{
+    this->pool = pool;
+    this->populationSize = max(2u, populationSize);
+    this->profiler = nullptr;
+}
+
+// Generates and evaluates the initial population and allocates every buffer of the run
+// seedFraction: share of the population built by the heuristic seeds (see generateSeededPopulation())
+// Time Complexity: O(P * S * C / T)
+// Space Complexity: O(P * S * C)
+template <class Selection, class Crossover, class Mutation, class Survivor, class Penalty>
+void GeneticAlgorithm<Selection, Crossover, Mutation, Survivor, Penalty>::initialize(double seedFraction)
+{
+    initialize(generateSeededPopulation(streams, pool, populationSize, seedFraction));
+}
+
+// Evaluates a given initial population and allocates every buffer of the run
+// The population size of the run becomes the size of start.
+// Time Complexity: O(P * S * C / T)
+// Space Complexity: O(P * S * C)
+template <class Selection, class Crossover, class Mutation, class Survivor, class Penalty>
+void GeneticAlgorithm<Selection, Crossover, Mutation, Survivor, Penalty>::initialize(Population start)
+{
+    parentPop = move(start);
+    populationSize = parentPop.size();
+    evaluate(parentPop, penalty, pool, true, profiler); // TC:O(P * S * C / T). P is population size, S stands for server number, C stands for client number
+
+    // Buffers reused by every generation: no allocation happens inside the loop
+    offspring = Population(parentPop.size(), parentPop.numServers, parentPop.numClients, parentPop.numGenes);
+    matingPool.reserve(parentPop.size());
+    survivorOrder.reserve(2 * parentPop.size());
+}
+
+// One generation: penalty update -> selection -> variation -> evaluate -> survivor
+// Each phase is timed when a profiler is set, the timers cost two clock reads per phase.
+// Time Complexity: O(P * S * C / T)
+// Space Complexity: O(1)
+template <class Selection, class Crossover, class Mutation, class Survivor, class Penalty>
+void GeneticAlgorithm<Selection, Crossover, Mutation, Survivor, Penalty>::step(unsigned int generation)
+{
+    if (penalty.update(parentPop, generation)) {
+        // New weights: the parents keep their scores, only their fitness is recombined
+        for (Chromosome& individual : parentPop.individuals) {
+            computeFitness(individual, penalty);
+        }
+        moveBestFirst(parentPop);
+    }
+    {
+        ScopedTimer timer(profiler, PROFILE_SELECTION);
+        Selection::select(parentPop, matingPool, streams, generation); //TC: O(POP) POP stands for size of population
+        fillOffspring(offspring, parentPop, matingPool, pool); //TC: O(POP * S*C / T)
+    }
+    {
+        ScopedTimer timer(profiler, PROFILE_VARIATION);
+        variation(generation); //Time Complexity: O(POP * (S*C) / T)
+    }
+    {
+        ScopedTimer timer(profiler, PROFILE_EVALUATE);
+        evaluate(offspring, penalty, pool, (generation + 1) % FULL_EVALUATION_INTERVAL == 0, profiler); // Incremental, except for the periodic full pass
+    }
+    if (PROFILING && profiler) {
+        unsigned long long infeasible = 0;
+        for (const Chromosome& individual : offspring.individuals) {
+            infeasible += !individual.isFeas;
+        }
+        profiler->count(PROFILE_INFEASIBLE, infeasible);
+        profiler->count(PROFILE_GENERATIONS);
+    }
+    if (memetic.repairOffspring) {
+        ScopedTimer timer(profiler, PROFILE_REPAIR);
+        repairOffspring(); //TC: O(POP * S*C / T) for the infeasible offspring
+    }
+    {
+        ScopedTimer timer(profiler, PROFILE_SURVIVOR);
+        Survivor::apply(offspring, parentPop, survivorOrder, pool); //  TC:O(P + K * S * C). K offspring replace parents
+    }
+    if (memetic.localSearchElites) {
+        ScopedTimer timer(profiler, PROFILE_LOCAL_SEARCH);
+        localSearch(generation); //TC: O(E * (L + S*C) / T)
+    }
+}
+
+// Time Complexity: O(1)
+// Space Complexity: O(1)
+template <class Selection, class Crossover, class Mutation, class Survivor, class Penalty>
+void GeneticAlgorithm<Selection, Crossover, Mutation, Survivor, Penalty>::setMemetic(const MemeticOptions& options)
+{
+    memetic = options;
+}
+
+// Time Complexity: O(1)
+// Space Complexity: O(1)
+template <class Selection, class Crossover, class Mutation, class Survivor, class Penalty>
+void GeneticAlgorithm<Selection, Crossover, Mutation, Survivor, Penalty>::setProfiler(Profiler* profiler)
+{
+    this->profiler = profiler;
+}
+
+// Projects every infeasible offspring back onto the constraints, then evaluates the repaired ones
+// The feasible offspring keep their evaluation, evaluate() skips them.
+// Time Complexity: O(POP * S*C / T)
+// Space Complexity: O(1)
+template <class Selection, class Crossover, class Mutation, class Survivor, class Penalty>
+void GeneticAlgorithm<Selection, Crossover, Mutation, Survivor, Penalty>::repairOffspring()
+{
+    Population& pop = offspring;
+    Profiler* counters = profiler;
+    auto repairRange = [&pop, counters](size_t begin, size_t end) {
+        unsigned long long repaired = 0;
+        for (size_t i = begin; i < end; i++) {
+            if (!pop[i].isFeas) {
+                repairIndividual(pop[i]); //TC: O(S*C)
+                repaired++;
+            }
+        }
+        if (PROFILING && counters) {
+            counters->count(PROFILE_REPAIRED, repaired);
+        }
+    };
+    if (pool) {
+        parallelSolve(*pool, pop.size(), repairRange);
+    } else {
+        repairRange(0, pop.size());
+    }
+    evaluate(offspring, penalty, pool, false, profiler);
+}
+
+// Bounded local search on the best localSearchElites individuals
+// Each move changes one random gene, either part of the way to its ideal allocation or by a random
+// factor of up to LOCAL_SEARCH_STEP, is scored in O(1) by updateGene() and is undone unless the
+// fitness improves. Each elite is fully re-evaluated afterwards, so no drift is left behind.
+// Time Complexity: O(E * (L + S*C) / T), E elites, L steps
+// Space Complexity: O(1)
+template <class Selection, class Crossover, class Mutation, class Survivor, class Penalty>
+void GeneticAlgorithm<Selection, Crossover, Mutation, Survivor, Penalty>::localSearch(unsigned int generation)
+{
+    vector<Chromosome>& views = parentPop.individuals;
+    size_t elites = min<size_t>(memetic.localSearchElites, views.size());
+    nth_element(views.begin(), views.begin() + elites - 1, views.end(), compareByFitness);
+
+    Population& pop = parentPop;
+    const RandomStreams& source = streams;
+    const Penalty& policy = penalty;
+    unsigned int steps = memetic.localSearchSteps;
+    auto polishRange = [&pop, &source, &policy, generation, steps](size_t begin, size_t end) {
+        GeneLayout layout = geneLayout();
+        const double* ideal = activeSolve->task.getIdealAllocations();
+        for (size_t e = begin; e < end; e++) {
+            Chromosome& elite = pop[e];
+            Rng rng = source.stream(PHASE_LOCAL_SEARCH, generation, e);
+            if (!elite.cacheValid) {
+                evaluateIndividual(elite); // The O(1) moves need up-to-date loads
+                computeFitness(elite, policy);
+            }
+            for (unsigned int step = 0; step < steps; step++) {
+                unsigned int server = rng.bounded(elite.numServers);
+                unsigned int rowSize = layout.edgeStart[server + 1] - layout.edgeStart[server];
+                if (rowSize == 0) {
+                    continue;
+                }
+                unsigned int k = layout.edgeStart[server] + rng.bounded(rowSize);
+                unsigned int client = layout.client(server, k);
+                double old = elite.ServerAllocations[k];
+                double value = rng.coin() ? old + rng.uniform() * (ideal[k] - old)
+                                          : old * (1.0 + LOCAL_SEARCH_STEP * (2.0 * rng.uniform() - 1.0));
+                value = max(min(value, (double)activeSolve->upperBounds[client]), 0.0);
+
+                double fitnessBefore = elite.fitness;
+                updateGene(elite, k, server, client, value);
+                computeFitness(elite, policy);
+                if (!(elite.fitness < fitnessBefore)) {
+                    updateGene(elite, k, server, client, old);
+                    computeFitness(elite, policy);
+                }
+            }
+            evaluateIndividual(elite);
+            computeFitness(elite, policy);
+        }
+    };
+    if (pool) {
+        parallelSolve(*pool, elites, polishRange);
+    } else {
+        polishRange(0, elites);
+    }
+    moveBestFirst(parentPop);
+}
+
+// Applies crossover and mutation on the offspring
+// Pairs are independent, so they are spread over the pool when one is given.
+// Each pair draws from its own stream, so the result does not depend on the number of threads.
+// With a profiler, each range sums its crossover and mutation times and adds them once.
+// Time Complexity: O(POP * (S*C) / T) S*C is time complexity of mutation, POP stands for population size, T stands for threads
+// Space complexity: O(1)
+template <class Selection, class Crossover, class Mutation, class Survivor, class Penalty>
+void GeneticAlgorithm<Selection, Crossover, Mutation, Survivor, Penalty>::variation(unsigned int generation)
+{
+    Population& pop = offspring;
+    const RandomStreams& source = streams;
+    Profiler* timers = PROFILING ? profiler : nullptr;
+    auto varyPairs = [&pop, &source, generation, timers](size_t begin, size_t end) {
+        unsigned long long crossoverNs = 0, mutationNs = 0, crossovers = 0, mutations = 0;
+        for (size_t pair = begin; pair < end; pair++) {
+            size_t i = 2 * pair;
+            Rng rng = source.stream(PHASE_VARIATION, generation, pair);
+
+            // Apply crossover with a given probability
+            if (rng.uniform() < crossoverProbability) {
+                unsigned long long start = timers ? profileClock() : 0;
+                Crossover::apply(pop[i], pop[i + 1], rng); //TC: O(S*C)
+                if (timers) {
+                    crossoverNs += profileClock() - start;
+                    crossovers++;
+                }
+            }
+
+            // Apply mutation to the first and second offspring with given probabilities
+            unsigned long long start = timers ? profileClock() : 0;
+            unsigned int mutated = 0;
+            if (rng.uniform() < mutationProbability) {
+                Mutation::apply(pop[i], rng); //TC: O(S*C)
+                mutated++;
+            }
+            if (rng.uniform() < mutationProbability) {
+                Mutation::apply(pop[i + 1], rng); //TC: O(S*C)
+                mutated++;
+            }
+            if (timers && mutated) {
+                mutationNs += profileClock() - start;
+                mutations += mutated;
+            }
+        }
+        if (timers) {
+            timers->addTime(PROFILE_CROSSOVER, crossoverNs, crossovers);
+            timers->addTime(PROFILE_MUTATION, mutationNs, mutations);
+        }
+    };
+
+    size_t pairs = pop.size() / 2;
+    if (pool) {
+        parallelSolve(*pool, pairs, varyPairs);
+    } else {
+        varyPairs(0, pairs);
+    }
+}
+
+// Evaluates one individual from scratch with the penalty policy of the run
+// Time Complexity: O(S * C)
+// Space Complexity: O(1)
+template <class Selection, class Crossover, class Mutation, class Survivor, class Penalty>
+void GeneticAlgorithm<Selection, Crossover, Mutation, Survivor, Penalty>::evaluateOne(Chromosome& individual) const
+{
+    evaluateIndividual(individual);
+    computeFitness(individual, penalty);
+}
+
+// Time Complexity: O(1)
+// Space Complexity: O(1)
+template <class Selection, class Crossover, class Mutation, class Survivor, class Penalty>
+Population& GeneticAlgorithm<Selection, Crossover, Mutation, Survivor, Penalty>::getPopulation()
+{
+    return parentPop;
+}
+
+// The survivor policies keep the best individual in slot 0, the scan also covers the initial population
+// Time Complexity: O(P)
+// Space Complexity: O(1)
+template <class Selection, class Crossover, class Mutation, class Survivor, class Penalty>
+Chromosome& GeneticAlgorithm<Selection, Crossover, Mutation, Survivor, Penalty>::best()
+{
+    moveBestFirst(parentPop);
+    return parentPop[0];
+}
+
+// Copy of one solution, detached from the population it was taken from
+struct SolutionSnapshot
+{
+    vector<Gene> genes; // Same layout as Chromosome::ServerAllocations
+    double fitness = INFINITY; // INFINITY -> no solution yet
+    double latencyScore = 0;
+    double loadImbalance = 0; // Second objective of the multi-objective mode
+    double violation = 0; // Third objective: capacity + bandwidth + connection penalties
+    bool isFeas = false;
+    unsigned int generation = 0; // Generation it was found in, 0 -> initial population
+    double seconds = 0; // Time since the start of the run
+};
+
+// Best solution found so far, written by the solver and readable from any thread while it runs (anytime mode)
+// The solver only takes the lock when the best fitness improves, fitness() never takes it.
+// A feasible solution beats any infeasible one: with the scheduled and adaptive penalties the fitness of
+// an infeasible solution depends on the weight of its generation.
+class BestSolution
+{
+    private:
+    mutable mutex snapshotMutex; // Protects best
+    SolutionSnapshot best;
+    atomic<double> bestFitness; // Copy of best.fitness for lock-free polling
+    atomic<bool> bestFeasible; // Copy of best.isFeas
+
+    public:
+    BestSolution(); // Constructor, starts without a solution.
+
+    // Methods
+    bool offer(const Chromosome& candidate, unsigned int generation, double seconds); // Keeps candidate if it is better, true if it was.
+    SolutionSnapshot snapshot() const; // Consistent copy of the best solution.
+    double fitness() const; // Fitness of the best solution, INFINITY before the first offer.
+};
+
+// Constructor
+// Time Complexity: O(1)
+// Space Complexity: O(1)
+BestSolution::BestSolution()
+{
+    this->bestFitness = INFINITY;
+    this->bestFeasible = false;
+}
+
+// True if a solution (fitness, feasible) is better than the best one (bestFitness, bestFeasible)
+// Time Complexity: O(1)
+// Space Complexity: O(1)
+bool betterSolution(double fitness, bool feasible, double bestFitness, bool bestFeasible)
+{
+    return feasible != bestFeasible ? feasible : fitness < bestFitness;
+}
+
+// Best individual of a population by betterSolution(), the one reported at the end of a run
+// Time Complexity: O(P)
+// Space Complexity: O(1)
+Chromosome& reportedBest(Population& pop)
+{
+    Chromosome* best = &pop[0];
+    for (Chromosome& individual : pop.individuals) {
+        if (betterSolution(individual.fitness, individual.isFeas, best->fitness, best->isFeas)) {
+            best = &individual;
+        }
+    }
+    return *best;
+}
+
+// The genes are copied under the lock, readers never see half of an update
+// Time Complexity: O(S * C) on improvement, O(1) otherwise
+// Space Complexity: O(S * C) for the first solution, the buffer is reused after that
+bool BestSolution::offer(const Chromosome& candidate, unsigned int generation, double seconds)
+{
+    if (!betterSolution(candidate.fitness, candidate.isFeas, bestFitness.load(memory_order_relaxed), bestFeasible.load(memory_order_relaxed))) {
+        return false;
+    }
+    lock_guard<mutex> lock(snapshotMutex);
+    if (!betterSolution(candidate.fitness, candidate.isFeas, best.fitness, best.isFeas)) {
+        return false; // Another island got there first
+    }
+    best.genes.assign(candidate.ServerAllocations, candidate.ServerAllocations + candidate.size());
+    best.fitness = candidate.fitness;
+    best.latencyScore = candidate.latencyScore;
+    best.isFeas = candidate.isFeas;
+    best.generation = generation;
+    best.seconds = seconds;
+    bestFeasible.store(candidate.isFeas, memory_order_relaxed);
+    bestFitness.store(candidate.fitness, memory_order_release);
+    return true;
+}
+
+// Time Complexity: O(S * C)
+// Space Complexity: O(S * C)
+SolutionSnapshot BestSolution::snapshot() const
+{
+    lock_guard<mutex> lock(snapshotMutex);
+    return best;
+}
+
+// Time Complexity: O(1)
+// Space Complexity: O(1)
+double BestSolution::fitness() const
+{
+    return bestFitness.load(memory_order_acquire);
+}
+
+// Non-dominated individuals among candidates, as snapshots sorted by latency score
+// Individuals with the same objective values as one already kept are skipped, so a front that
+// converged to copies of one solution yields one entry.
+// Time Comp: O(N^2 * M + F * S * C), N stands for the candidates, F for the front size
+// Space Comp: O(N * M + F * S * C)
+void collectParetoFront(const vector<const Chromosome*>& candidates, vector<SolutionSnapshot>& front)
+{
+    size_t n = candidates.size();
+    vector<double> objectives(n * OBJECTIVES);
+    for (size_t k = 0; k < n; k++) {
+        objectiveValues(*candidates[k], &objectives[k * OBJECTIVES]);
+    }
+    vector<size_t> members;
+    for (size_t i = 0; i < n; i++) {
+        bool keep = true;
+        for (size_t j = 0; j < n && keep; j++) {
+            keep = dominance(&objectives[j * OBJECTIVES], &objectives[i * OBJECTIVES]) <= 0;
+        }
+        for (size_t m = 0; m < members.size() && keep; m++) {
+            keep = !equal(&objectives[i * OBJECTIVES], &objectives[i * OBJECTIVES] + OBJECTIVES, &objectives[members[m] * OBJECTIVES]);
+        }
+        if (keep) {
+            members.push_back(i);
+        }
+    }
+    sort(members.begin(), members.end(), [&objectives](size_t a, size_t b) {
+        return objectives[a * OBJECTIVES] < objectives[b * OBJECTIVES] || (objectives[a * OBJECTIVES] == objectives[b * OBJECTIVES] && a < b);
+    });
+
+    front.resize(members.size());
+    for (size_t f = 0; f < members.size(); f++) {
+        const Chromosome& indi = *candidates[members[f]];
+        SolutionSnapshot& snapshot = front[f];
+        snapshot.genes.assign(indi.ServerAllocations, indi.ServerAllocations + indi.size());
+        snapshot.fitness = indi.fitness;
+        snapshot.latencyScore = objectives[members[f] * OBJECTIVES];
+        snapshot.loadImbalance = objectives[members[f] * OBJECTIVES + 1];
+        snapshot.violation = objectives[members[f] * OBJECTIVES + 2];
+        snapshot.isFeas = indi.isFeas;
+    }
+}
+
+// One line per member of a Pareto front
+// Time Comp: O(F)
+// Space Comp: O(1)
+void printParetoFront(const vector<SolutionSnapshot>& front)
+{
+    cout << "Pareto front (" << front.size() << " solutions):" << endl;
+    for (size_t f = 0; f < front.size(); f++) {
+        cout << "  " << f << ": LatencyScore = " << front[f].latencyScore << " Load Imbalance = " << front[f].loadImbalance
+             << " Violation = " << front[f].violation << " Fitness = " << front[f].fitness << endl;
+    }
+}
+
+// Runtime settings of a run, the defaults come from the macros above
+struct GAConfig
+{
+    uint64_t seed = time(NULL); // Every random draw of the run derives from it
+    unsigned int numThreads = WORKER_THREADS; // 0 -> one per hardware thread, 1 -> serial
+    unsigned int populationSize = POPULATION;
+    unsigned int generations = GENERATIONS;
+    unsigned int selectionMethod = SELECTION_METHOD; // 1 -> binary tournament
+    unsigned int crossoverMethod = CROSSOVER_METHOD; // 1 -> BLX-alpha, 2 -> SBX
+    unsigned int mutationMethod = MUTATION_METHOD; // 1 -> random
+    bool elitism = ELITISM; // true -> elitist_full, false -> non_elitist
+    unsigned int penaltyMethod = PENALTY_METHOD; // 1 -> static, 2 -> generation-scheduled, 3 -> adaptive
+    bool verbose = Verbose;
+    bool printBest = true; // false -> the result is only returned through bestSolution, paretoFront and population
+
+    // Stopping criteria, the run ends at the first one met (or after generations)
+    unsigned int stagnationGenerations = STAGNATION_GENERATIONS; // 0 -> never
+    double targetFitness = TARGET_FITNESS;
+    double minDiversity = MIN_DIVERSITY; // 0 -> never
+    double timeBudget = TIME_BUDGET; // Seconds, 0 -> no deadline
+
+    // Anytime access to the best solution so far, both optional
+    BestSolution* bestSolution = nullptr; // Updated on every improvement, may be read from another thread
+    function<void(const BestSolution&)> onImprovement; // Called after each improvement, from the island threads in the island model
+
+    // Per-generation statistics, optional: pushed without blocking, written by the sink's own thread
+    TelemetrySink* telemetry = nullptr;
+
+    // Warm start: the final population of a previous run on the same task shape (empty -> random start),
+    // replaced by the final population of this run. Not used by the island model.
+    Population* population = nullptr;
+    double warmStartFresh = WARM_START_FRESH; // Share of a warm start generated at random
+    double seedFraction = SEED_FRACTION; // Share of a cold start built by the heuristic seeds, 0 -> random
+    MemeticOptions memetic; // Repair of infeasible offspring and local search on the elites
+    bool profile = PROFILE_REPORT; // Time every phase and print a summary at the end of the run
+
+    // NSGA-II on (latency score, load imbalance, violation): crowded tournament and non-dominated survivor
+    // selection replace the configured operators. The weighted fitness still picks the printed best solution.
+    bool multiObjective = MULTI_OBJECTIVE;
+    vector<SolutionSnapshot>* paretoFront = nullptr; // Receives the final non-dominated set, optional
+};
+
+// Memetic options of a run: local search follows the weighted fitness, so it is off in multi-objective mode
+// Time Comp: O(1)
+// Space Comp: O(1)
+MemeticOptions runMemetic(const GAConfig& config)
+{
+    MemeticOptions memetic = config.memetic;
+    if (config.multiObjective) {
+        memetic.localSearchElites = 0;
+    }
+    return memetic;
+}
+
+// Why a run stopped
+enum StopReason
+{
+    STOP_GENERATIONS, // Every generation ran
+    STOP_STAGNATION, // No improvement for stagnationGenerations generations
+    STOP_TARGET, // Best fitness reached targetFitness
+    STOP_DIVERSITY, // Population diversity fell below minDiversity
+    STOP_TIME_BUDGET // The next generation would not finish within timeBudget
+};
+
+// Time Comp: O(1)
+// Space Comp: O(1)
+const char* stopReasonName(StopReason reason)
+{
+    switch (reason) {
+        case STOP_STAGNATION: return "stagnation";
+        case STOP_TARGET: return "target fitness reached";
+        case STOP_DIVERSITY: return "diversity collapse";
+        case STOP_TIME_BUDGET: return "time budget";
+        default: return "generation limit";
+    }
+}
+
+// Genotype diversity of a population: mean absolute difference between the genes of each individual
+// and the genes of the best one, relative to the mean client upper bound.
+// About 1/3 for a random population, 0 once every individual is a copy of the best.
+// distances: scratch buffer with one slot per individual, so measuring does not allocate
+// Time Comp: O(P * S * C / T)
+// Space Comp: O(1)
+double populationDiversity(const Population& pop, const Chromosome& best, vector<double>& distances, ThreadPool* pool)
+{
+    distances.resize(pop.size());
+    auto measure = [&pop, &best, &distances](size_t begin, size_t end) {
+        for (size_t k = begin; k < end; k++) {
+            const Gene* genes = pop[k].ServerAllocations;
+            double distance = 0;
+            for (unsigned int g = 0; g < best.size(); g++) {
+                distance += fabs(genes[g] - best.ServerAllocations[g]);
+            }
+            distances[k] = distance;
+        }
+    };
+    if (pool) {
+        parallelSolve(*pool, pop.size(), measure);
+    } else {
+        measure(0, pop.size());
+    }
+
+    double total = 0; // Summed in index order, the result does not depend on the number of threads
+    for (double distance : distances) {
+        total += distance;
+    }
+    double boundSum = 0;
+    for (unsigned int bound : activeSolve->upperBounds) {
+        boundSum += bound;
+    }
+    double meanBound = activeSolve->upperBounds.empty() ? 0 : boundSum / activeSolve->upperBounds.size();
+    if (meanBound <= 0 || best.size() == 0) {
+        return 0;
+    }
+    return total / ((double)pop.size() * best.size() * meanBound);
+}
+
+// Checks the stopping criteria of a GAConfig after every generation and publishes improvements
+// The clock starts at construction, so the time budget also covers the setup of the run.
+class ConvergenceMonitor
+{
+    private:
+    typedef chrono::steady_clock Clock;
+
+    const GAConfig& config;
+    BestSolution ownBest; // Used when the config does not provide one
+    BestSolution& bestSolution; // Best solution of the run
+    Clock::time_point start; // Start of the run
+    Clock::time_point lastCheck; // End of the previous generation
+    double bestFitness; // Best fitness at the last real improvement (beyond STAGNATION_TOLERANCE)
+    unsigned int lastImprovement; // Generation of that improvement
+    StopReason reason;
+    unsigned int island; // Reported in the telemetry records
+    vector<double> distances; // Scratch buffer of populationDiversity()
+
+    void report(const Population& pop, const Chromosome& best, unsigned int generation, double seconds, double diversity); // Pushes a telemetry record.
+
+    public:
+    ConvergenceMonitor(const GAConfig& config, BestSolution* shared = nullptr, unsigned int island = 0); // shared -> best solution of several monitors (islands).
+
+    // Methods
+    bool update(const Population& pop, unsigned int generation, ThreadPool* pool = nullptr); // Call after each generation, true -> stop.
+    StopReason stopReason() const; // Why update() returned true, STOP_GENERATIONS if it never did.
+    double elapsed() const; // Seconds since the start of the run.
+};
+
+// Constructor
+// Time Complexity: O(1)
+// Space Complexity: O(1)
+ConvergenceMonitor::ConvergenceMonitor(const GAConfig& config, BestSolution* shared, unsigned int island)
+    : config(config), bestSolution(shared ? *shared : config.bestSolution ? *config.bestSolution : ownBest)
+{
+    this->start = Clock::now();
+    this->lastCheck = this->start;
+    this->bestFitness = INFINITY;
+    this->lastImprovement = 0;
+    this->reason = STOP_GENERATIONS;
+    this->island = island;
+}
+
+// generation: generations run so far, 0 for the initial population
+// The deadline check stops before a generation that would overrun the budget, assuming it takes as
+// long as the previous one (as long as the setup for the first one). A generation is never cut short.
+// Time Complexity: O(P), plus O(P * S * C / T) every DIVERSITY_INTERVAL generations and O(S * C) on improvement
+// Space Complexity: O(1)
+bool ConvergenceMonitor::update(const Population& pop, unsigned int generation, ThreadPool* pool)
+{
+    Clock::time_point now = Clock::now();
+    double seconds = chrono::duration<double>(now - start).count();
+    double lastGeneration = chrono::duration<double>(now - lastCheck).count();
+    lastCheck = now;
+
+    const Chromosome& best = *min_element(pop.individuals.begin(), pop.individuals.end(), compareByFitness);
+    if (bestSolution.offer(best, generation, seconds) && config.onImprovement) {
+        config.onImprovement(bestSolution);
+    }
+    // Measured once for both the telemetry and the diversity criterion
+    double diversity = NAN;
+    if ((config.telemetry || config.minDiversity > 0) && generation % DIVERSITY_INTERVAL == 0) {
+        diversity = populationDiversity(pop, best, distances, pool);
+    }
+    if (config.telemetry) {
+        report(pop, best, generation, seconds, diversity);
+    }
+    if (best.fitness < bestFitness - STAGNATION_TOLERANCE * fabs(bestFitness) || generation == 0) {
+        bestFitness = best.fitness;
+        lastImprovement = generation;
+    }
+
+    if (best.fitness <= config.targetFitness) {
+        reason = STOP_TARGET;
+    } else if (config.timeBudget > 0 && seconds + lastGeneration >= config.timeBudget) {
+        reason = STOP_TIME_BUDGET;
+    } else if (config.stagnationGenerations && generation - lastImprovement >= config.stagnationGenerations) {
+        reason = STOP_STAGNATION;
+    } else if (config.minDiversity > 0 && generation && diversity < config.minDiversity) {
+        reason = STOP_DIVERSITY;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+// Fitness spread, feasible share and the penalty breakdown of the best individual, without blocking
+// Time Complexity: O(P)
+// Space Complexity: O(1)
+void ConvergenceMonitor::report(const Population& pop, const Chromosome& best, unsigned int generation, double seconds, double diversity)
+{
+    GenerationStats stats;
+    stats.island = island;
+    stats.generation = generation;
+    stats.seconds = seconds;
+    stats.bestFitness = best.fitness;
+    stats.worstFitness = best.fitness;
+    double total = 0;
+    unsigned int feasible = 0;
+    for (const Chromosome& individual : pop.individuals) {
+        total += individual.fitness;
+        stats.worstFitness = max(stats.worstFitness, individual.fitness);
+        feasible += individual.isFeas;
+    }
+    stats.meanFitness = pop.size() ? total / pop.size() : best.fitness;
+    stats.feasibleRatio = pop.size() ? (double)feasible / pop.size() : 0;
+    stats.diversity = diversity;
+    stats.latencyScore = best.latencyScore;
+    stats.penaltyCapacity = best.penaltyCapacity;
+    stats.penaltyBandwith = best.penaltyBandwith;
+    stats.connectionPen = best.connectionPen;
+    config.telemetry->push(stats);
+}
+
+// Time Complexity: O(1)
+// Space Complexity: O(1)
+StopReason ConvergenceMonitor::stopReason() const
+{
+    return reason;
+}
+
+// Time Complexity: O(1)
+// Space Complexity: O(1)
+double ConvergenceMonitor::elapsed() const
+{
+    return chrono::duration<double>(Clock::now() - start).count();
+}
+
+// Names an engine type without constructing it, passed to the visitor of dispatchEngine()
+template <class Engine>
+struct EngineTag
+{
+    typedef Engine type;
+};
+
+// Last level of dispatchEngine(): picks the penalty policy of config.penaltyMethod
+// Time Complexity: O(1) plus the visitor
+// Space Complexity: O(1)
+template <class Selection, class Crossover, class Survivor, class Visitor>
+void dispatchPenalty(const GAConfig& config, Visitor&& visitor)
+{
+    if (config.penaltyMethod == 2) {
+        visitor(EngineTag<GeneticAlgorithm<Selection, Crossover, RandomMutation, Survivor, ScheduledPenalty>>());
+    } else if (config.penaltyMethod == 3) {
+        visitor(EngineTag<GeneticAlgorithm<Selection, Crossover, RandomMutation, Survivor, AdaptivePenalty>>());
+    } else {
+        visitor(EngineTag<GeneticAlgorithm<Selection, Crossover, RandomMutation, Survivor, StaticPenalty>>());
+    }
+}
+
+// Picks the prebuilt instantiation matching a config and calls visitor(EngineTag<Engine>())
+// Unknown method numbers fall back to the default operator with a message. The multi-objective mode
+// ignores the selection method, elitism (NSGA-II is elitist by construction) and the penalty method.
+// Time Complexity: O(1) plus the visitor
+// Space Complexity: O(1)
+template <class Visitor>
+void dispatchEngine(const GAConfig& config, Visitor&& visitor)
+{
+    if (config.selectionMethod != 1) {
+        cout << "Unknown selection method " << config.selectionMethod << ", using binary tournament" << endl;
+    }
+    if (config.mutationMethod != 1) {
+        cout << "Unknown mutation method " << config.mutationMethod << ", using random mutation" << endl;
+    }
+    if (config.penaltyMethod < 1 || config.penaltyMethod > 3) {
+        cout << "Unknown penalty method " << config.penaltyMethod << ", using static penalty" << endl;
+    }
+    if (config.crossoverMethod != 1 && config.crossoverMethod != 2) {
+        cout << "Unknown crossover method " << config.crossoverMethod << ", using SBX" << endl;
+    }
+
+    if (config.multiObjective) {
+        if (config.crossoverMethod == 1) {
+            visitor(EngineTag<GeneticAlgorithm<CrowdedTournamentSelection, BlxAlphaCrossover, RandomMutation, NsgaSurvivor, StaticPenalty>>());
+        } else {
+            visitor(EngineTag<GeneticAlgorithm<CrowdedTournamentSelection, SbxCrossover, RandomMutation, NsgaSurvivor, StaticPenalty>>());
+        }
+    } else if (config.crossoverMethod == 1) {
+        if (config.elitism) {
+            dispatchPenalty<BinaryTournamentSelection, BlxAlphaCrossover, ElitistSurvivor>(config, visitor);
+        } else {
+            dispatchPenalty<BinaryTournamentSelection, BlxAlphaCrossover, GenerationalSurvivor>(config, visitor);
+        }
+    } else {
+        if (config.elitism) {
+            dispatchPenalty<BinaryTournamentSelection, SbxCrossover, ElitistSurvivor>(config, visitor);
+        } else {
+            dispatchPenalty<BinaryTournamentSelection, SbxCrossover, GenerationalSurvivor>(config, visitor);
+        }
+    }
+}
+
+// Runs one engine until the monitor stops it or config.generations generations ran, prints the best solution
+// profiler: receives the phase times and counters of the run, null -> not profiled
+// Time Complexity: O(G * (P * S * C) / T)
+// Space Complexity: O(P * S * C)
+template <class Engine>
+void runEngine(const GAConfig& config, ThreadPool& pool, ConvergenceMonitor& monitor, Profiler* profiler)
+{
+    Engine engine(RandomStreams(config.seed), &pool, config.populationSize);
+    engine.setMemetic(runMemetic(config));
+    engine.setProfiler(profiler);
+    Population* previous = config.population;
+    if (previous && previous->size() && (previous->numServers != activeSolve->task.getNumServers()
+        || previous->numClients != activeSolve->task.getNumClients() || previous->numGenes != activeSolve->task.getNumGenes())) {
+        cout << "Warm start population does not match the task, starting from a random population" << endl;
+        previous = nullptr;
+    }
+    {
+        ScopedTimer timer(profiler, PROFILE_INITIALIZATION);
+        if (previous && previous->size()) {
+            engine.initialize(reseedPopulation(*previous, RandomStreams(config.seed), &pool, config.populationSize, config.warmStartFresh));
+        } else {
+            engine.initialize(config.seedFraction);
+        }
+    }
+
+    unsigned int generation = 0;
+    bool stop = monitor.update(engine.getPopulation(), 0, &pool);
+    while (!stop && generation < config.generations) {
+        engine.step(generation++);
+
+        if(config.verbose){
+            // One line per generation, the full statistics go to config.telemetry
+            Chromosome& current = engine.best();
+            cout << "Generation " << generation << " Fitness = " << current.fitness << " LatencyScore = " << current.latencyScore
+                 << " Penalty Capacity = " << current.penaltyCapacity << " Penalty Bandwith = " << current.penaltyBandwith << '\n';
+        }
+        if (config.telemetry && config.telemetry->takeDumpRequest()) {
+            cout << "Generation " << generation << " Current Best: " << endl;
+            printIndividual(engine.best());
+        }
+        ScopedTimer timer(profiler, PROFILE_MONITOR);
+        stop = monitor.update(engine.getPopulation(), generation, &pool);
+    }
+    if(config.verbose){
+        cout << "Stopped after " << generation << " generations (" << stopReasonName(monitor.stopReason()) << ") in "
+             << monitor.elapsed() << " s" << endl;
+    }
+    // Print the best solution found
+    Chromosome& best = reportedBest(engine.getPopulation());
+    if (config.printBest) {
+        cout << "Best: " << endl;
+        printIndividual(best);
+        cout << "Fitness = " << best.fitness << endl;
+    }
+    if (config.multiObjective) {
+        vector<const Chromosome*> candidates;
+        for (const Chromosome& individual : engine.getPopulation().individuals) {
+            candidates.push_back(&individual);
+        }
+        vector<SolutionSnapshot> front;
+        collectParetoFront(candidates, front);
+        if (config.printBest) {
+            printParetoFront(front);
+        }
+        if (config.paretoFront) {
+            *config.paretoFront = move(front);
+        }
+    }
+    if (config.population) {
+        *config.population = move(engine.getPopulation()); // The engine is done with it
+    }
+}
+
+// Main genetic algorithm function on a given thread pool, which can be reused from one run to the next
+// The run has its own SolveContext, so threads with their own pools can solve different tasks at once.
+// Time Complexity: O(G * (P * S * C) / T)
+// Space Complexity: O(P * S * C)
+void geneticAlgorithm(Task task1, const GAConfig& config, ThreadPool& pool) {
+    ConvergenceMonitor monitor(config); // Starts the clock of config.timeBudget
+    SolveContext context; // Bound to this thread and, through parallelSolve(), to the pool workers
+    context.task = move(task1);
+    context.task.freeze(); // TC: O(S * C), builds the latency tables used by every evaluation
+    SolveScope scope(context);
+    findUpperBound(); // TC: O(C) C stands for clients
+    if(config.verbose){
+        cout << "Seed = " << config.seed << endl;
+    }
+    Profiler profiler;
+    dispatchEngine(config, [&](auto tag) {
+        runEngine<typename decltype(tag)::type>(config, pool, monitor, config.profile ? &profiler : nullptr);
+    });
+    if (config.profile) {
+        profiler.report(monitor.elapsed());
+    }
+}
+
+// Main genetic algorithm function
+// config.seed: every random draw of the run derives from it, the same seed gives the same result for any numThreads
+// config.numThreads: worker threads for evaluation and variation (0 -> one per hardware thread, 1 -> serial)
+// The stopping criteria of config can end the run early, config.bestSolution follows it while it runs.
+// config.profile: prints the time spent in each phase and the event counters at the end.
+// Time Complexity: O(G * (P * S * C) / T), where G is the number of generations, P is population size, S stands for server number, C stands for client number, T stands for threads
+// Space Complexity: O(P * S * C).  P is population size, S stands for server number, C stands for client number
+void geneticAlgorithm(Task task1, const GAConfig& config) {
+    ThreadPool pool(config.numThreads);
+    geneticAlgorithm(task1, config, pool);
+}
+
+// Genetic algorithm with the operators selected by the macros
+// Time Complexity: O(G * (P * S * C) / T)
+// Space Complexity: O(P * S * C)
+void geneticAlgorithm(Task task1, uint64_t seed = time(NULL), unsigned int numThreads = WORKER_THREADS) {
+    GAConfig config;
+    config.seed = seed;
+    config.numThreads = numThreads;
+    geneticAlgorithm(task1, config);
+}
+
+// Warm-start re-optimization after the bandwidths or capacities of a task drifted
+// Applies delta to task, then evolves population (the final population of the previous run on this
+// task, empty for the first call) under the new bounds; population receives the new final population.
+// The run starts from the repaired previous solutions, so a much smaller config.generations or
+// config.timeBudget than for a cold start is usually enough. The stopping criteria apply as usual.
+// Time Complexity: O(D + G * (P * S * C) / T), D stands for the number of changes in delta
+// Space Complexity: O(P * S * C)
+bool rebalance(Task& task, const TaskDelta& delta, const GAConfig& config, Population& population) {
+    if (!task.applyDelta(delta)) {
+        return false;
+    }
+    GAConfig warmConfig = config;
+    warmConfig.population = &population;
+    geneticAlgorithm(task, warmConfig);
+    return true;
+}
+
+#endif
@@ -0,0 +1,472 @@
+#ifndef INSTANCEFILE_H
+#define INSTANCEFILE_H
+
+// Binary instance format, memory-mapped loader and streaming CSV importer
+//
+// Binary layout (little-endian, every section starts on a 64-byte boundary):
+//   offset 0               InstanceHeader (64 bytes)
+//   latencyOffset   = 64   S x C float64 latencies, row-major (server i, client j at i * C + j)
+//   bandwidthOffset        C uint32 client bandwidths
+//   capacityOffset         S uint32 server capacities
+// The latency block starts right after the header whatever the dimensions, so a writer can stream
+// rows before it knows how many servers there are and fill in the header at the end.
+// A loaded file is mapped read-only, the latencies are used in place and never copied.
+//
+// CSV layout read by importCsvInstance(), values separated by commas, semicolons or whitespace:
+//   # comment lines and blank lines are ignored
+//   bandwidth,10,20,30     one value per client
+//   capacity,100,100       one value per server
+//   2.3,4.5,2.0            one row of C latencies per server, all strictly positive and finite
+// The bandwidth and capacity lines may appear anywhere, every other line is a latency row.
+
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#define INSTANCE_MAGIC "GALBINST"
+#define INSTANCE_VERSION 1
+#define INSTANCE_ALIGNMENT 64
+#define INSTANCE_LATENCY_RULE "latencies must be > 0 and finite" // Message of both validLatency() callers
+
+using namespace std;
+
+// Latencies are inverted by the solver: the importer and Task::loadInstance() accept the same ones
+// Time Complexity: O(1)
+// Space Complexity: O(1)
+bool validLatency(double latency)
+{
+    return latency > 0 && isfinite(latency);
+}
+
+// Fixed-size header at the start of every instance file
+struct InstanceHeader
+{
+    char magic[8]; // INSTANCE_MAGIC, not null terminated
+    uint32_t version; // INSTANCE_VERSION
+    uint32_t headerSize; // sizeof(InstanceHeader)
+    uint64_t numServers;
+    uint64_t numClients;
+    uint64_t latencyOffset; // Byte offsets of the three sections
+    uint64_t bandwidthOffset;
+    uint64_t capacityOffset;
+    uint64_t fileSize; // Total size, a truncated file is rejected
+};
+
+// Rounds an offset up to the next section boundary
+// Time Complexity: O(1)
+// Space Complexity: O(1)
+uint64_t alignInstanceOffset(uint64_t offset)
+{
+    return (offset + INSTANCE_ALIGNMENT - 1) / INSTANCE_ALIGNMENT * INSTANCE_ALIGNMENT;
+}
+
+// Header of an instance with the given dimensions
+// Time Complexity: O(1)
+// Space Complexity: O(1)
+InstanceHeader makeInstanceHeader(uint64_t numServers, uint64_t numClients)
+{
+    InstanceHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, INSTANCE_MAGIC, sizeof(header.magic));
+    header.version = INSTANCE_VERSION;
+    header.headerSize = sizeof(InstanceHeader);
+    header.numServers = numServers;
+    header.numClients = numClients;
+    header.latencyOffset = alignInstanceOffset(sizeof(InstanceHeader));
+    header.bandwidthOffset = alignInstanceOffset(header.latencyOffset + numServers * numClients * sizeof(double));
+    header.capacityOffset = alignInstanceOffset(header.bandwidthOffset + numClients * sizeof(uint32_t));
+    header.fileSize = header.capacityOffset + numServers * sizeof(uint32_t);
+    return header;
+}
+
+// Read-only memory mapping of an instance file
+// The mapping lives as long as the object, a Task shares it through a shared_ptr.
+class MappedInstance
+{
+    private:
+    const unsigned char* base; // First byte of the mapping, null if nothing is mapped
+    size_t length; // Mapped bytes
+#ifdef _WIN32
+    HANDLE fileHandle;
+    HANDLE mappingHandle;
+#endif
+
+    void unmap(); // Releases the mapping.
+
+    public:
+    MappedInstance(); // Constructor, maps nothing.
+    ~MappedInstance(); // Unmaps the file.
+    MappedInstance(const MappedInstance&) = delete;
+    MappedInstance& operator=(const MappedInstance&) = delete;
+
+    // Methods
+    bool open(const string& path); // Maps and validates a file, prints the reason and returns false on error.
+    const InstanceHeader& header() const; // Header of the mapped file.
+    const double* latencies() const; // Row-major S x C latencies.
+    const uint32_t* bandwidths() const; // C client bandwidths.
+    const uint32_t* capacities() const; // S server capacities.
+};
+
+// Constructor
+// Time Complexity: O(1)
+// Space Complexity: O(1)
+MappedInstance::MappedInstance()
+{
+    this->base = nullptr;
+    this->length = 0;
+#ifdef _WIN32
+    this->fileHandle = INVALID_HANDLE_VALUE;
+    this->mappingHandle = NULL;
+#endif
+}
+
+// Destructor
+// Time Complexity: O(1)
+// Space Complexity: O(1)
+MappedInstance::~MappedInstance()
+{
+    unmap();
+}
+
+// Time Complexity: O(1), the pages are released by the OS
+// Space Complexity: O(1)
+void MappedInstance::unmap()
+{
+#ifdef _WIN32
+    if (base) {
+        UnmapViewOfFile(base);
+    }
+    if (mappingHandle) {
+        CloseHandle(mappingHandle);
+    }
+    if (fileHandle != INVALID_HANDLE_VALUE) {
+        CloseHandle(fileHandle);
+    }
+    mappingHandle = NULL;
+    fileHandle = INVALID_HANDLE_VALUE;
+#else
+    if (base) {
+        munmap((void*)base, length);
+    }
+#endif
+    base = nullptr;
+    length = 0;
+}
+
+// Maps a file and checks its header against its size, no latency is read
+// Time Complexity: O(1), pages are loaded lazily when the latencies are first touched
+// Space Complexity: O(1) resident, the mapping is backed by the file
+bool MappedInstance::open(const string& path)
+{
+    unmap();
+#ifdef _WIN32
+    fileHandle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    LARGE_INTEGER size;
+    if (fileHandle == INVALID_HANDLE_VALUE || !GetFileSizeEx(fileHandle, &size)) {
+        cout << "Cannot open instance file " << path << endl;
+        unmap();
+        return false;
+    }
+    length = (size_t)size.QuadPart;
+    if (length >= sizeof(InstanceHeader)) {
+        mappingHandle = CreateFileMappingA(fileHandle, NULL, PAGE_READONLY, 0, 0, NULL);
+        base = mappingHandle ? (const unsigned char*)MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0) : nullptr;
+    }
+#else
+    int fd = ::open(path.c_str(), O_RDONLY);
+    struct stat info;
+    if (fd < 0 || fstat(fd, &info) != 0) {
+        cout << "Cannot open instance file " << path << endl;
+        if (fd >= 0) {
+            close(fd);
+        }
+        return false;
+    }
+    length = (size_t)info.st_size;
+    if (length >= sizeof(InstanceHeader)) {
+        void* mapped = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        base = mapped == MAP_FAILED ? nullptr : (const unsigned char*)mapped;
+    }
+    close(fd); // The mapping keeps the file alive
+#endif
+    if (!base) {
+        cout << "Cannot map instance file " << path << " (empty or too small)" << endl;
+        unmap();
+        return false;
+    }
+
+    const InstanceHeader& h = header();
+    bool valid = memcmp(h.magic, INSTANCE_MAGIC, sizeof(h.magic)) == 0 && h.version == INSTANCE_VERSION
+                 && h.headerSize == sizeof(InstanceHeader) && h.numServers > 0 && h.numClients > 0
+                 && h.numServers <= UINT32_MAX && h.numClients <= UINT32_MAX
+                 && h.numServers * h.numClients <= length / sizeof(double);
+    if (valid) {
+        // The offsets must be exactly the ones of the documented layout
+        InstanceHeader expected = makeInstanceHeader(h.numServers, h.numClients);
+        valid = h.latencyOffset == expected.latencyOffset && h.bandwidthOffset == expected.bandwidthOffset
+                && h.capacityOffset == expected.capacityOffset && h.fileSize == expected.fileSize
+                && h.fileSize <= length;
+    }
+    if (!valid) {
+        cout << "Invalid instance file " << path << " (bad header or truncated)" << endl;
+        unmap();
+        return false;
+    }
+    return true;
+}
+
+// Time Complexity: O(1)
+// Space Complexity: O(1)
+const InstanceHeader& MappedInstance::header() const
+{
+    return *(const InstanceHeader*)base;
+}
+
+// Time Complexity: O(1)
+// Space Complexity: O(1)
+const double* MappedInstance::latencies() const
+{
+    return (const double*)(base + header().latencyOffset);
+}
+
+// Time Complexity: O(1)
+// Space Complexity: O(1)
+const uint32_t* MappedInstance::bandwidths() const
+{
+    return (const uint32_t*)(base + header().bandwidthOffset);
+}
+
+// Time Complexity: O(1)
+// Space Complexity: O(1)
+const uint32_t* MappedInstance::capacities() const
+{
+    return (const uint32_t*)(base + header().capacityOffset);
+}
+
+// Sequential writer of an instance file: latency rows are streamed, the header is written last
+class InstanceWriter
+{
+    private:
+    FILE* file;
+    string path;
+    uint64_t position; // Bytes written so far, ftell is 32-bit on some platforms
+    uint64_t numClients; // Row length
+    uint64_t rows; // Latency rows written so far
+
+    bool write(const void* data, uint64_t bytes); // Appends bytes.
+    bool pad(uint64_t offset); // Writes zeros up to offset.
+
+    public:
+    InstanceWriter(); // Constructor.
+    ~InstanceWriter(); // Closes an unfinished file.
+
+    // Methods
+    bool open(const string& path, uint64_t numClients); // Creates the file, C must be known up front.
+    bool writeLatencyRow(const double* row); // Appends the C latencies of the next server.
+    bool finish(const vector<uint32_t>& bandwidths, const vector<uint32_t>& capacities); // Writes the rest and the header.
+    void discard(); // Closes and deletes an unfinished file.
+};
+
+// Constructor
+// Time Complexity: O(1)
+// Space Complexity: O(1)
+InstanceWriter::InstanceWriter()
+{
+    this->file = nullptr;
+    this->position = 0;
+    this->numClients = 0;
+    this->rows = 0;
+}
+
+// Destructor: a file that was not finished is incomplete and is deleted
+// Time Complexity: O(1)
+// Space Complexity: O(1)
+InstanceWriter::~InstanceWriter()
+{
+    discard();
+}
+
+// Time Complexity: O(1)
+// Space Complexity: O(1)
+void InstanceWriter::discard()
+{
+    if (file) {
+        fclose(file);
+        file = nullptr;
+        remove(path.c_str());
+    }
+}
+
+// Time Complexity: O(1)
+// Space Complexity: O(1)
+bool InstanceWriter::open(const string& path, uint64_t numClients)
+{
+    file = fopen(path.c_str(), "wb");
+    if (!file) {
+        cout << "Cannot create instance file " << path << endl;
+        return false;
+    }
+    this->path = path;
+    this->position = 0;
+    this->numClients = numClients;
+    this->rows = 0;
+    return pad(alignInstanceOffset(sizeof(InstanceHeader))); // Placeholder for the header
+}
+
+// Time Complexity: O(bytes)
+// Space Complexity: O(1)
+bool InstanceWriter::write(const void* data, uint64_t bytes)
+{
+    position += bytes;
+    return fwrite(data, 1, bytes, file) == bytes;
+}
+
+// Sections are at most INSTANCE_ALIGNMENT - 1 bytes apart
+// Time Complexity: O(1)
+// Space Complexity: O(1)
+bool InstanceWriter::pad(uint64_t offset)
+{
+    static const char zeros[INSTANCE_ALIGNMENT] = {0};
+    return write(zeros, offset - position);
+}
+
+// Time Complexity: O(C)
+// Space Complexity: O(1)
+bool InstanceWriter::writeLatencyRow(const double* row)
+{
+    rows++;
+    return write(row, numClients * sizeof(double));
+}
+
+// Writes the bandwidth and capacity sections, then the header now that S is known
+// Time Complexity: O(S + C)
+// Space Complexity: O(1)
+bool InstanceWriter::finish(const vector<uint32_t>& bandwidths, const vector<uint32_t>& capacities)
+{
+    InstanceHeader header = makeInstanceHeader(rows, numClients);
+    bool ok = bandwidths.size() == numClients && capacities.size() == rows
+              && pad(header.bandwidthOffset) && write(bandwidths.data(), numClients * sizeof(uint32_t))
+              && pad(header.capacityOffset) && write(capacities.data(), rows * sizeof(uint32_t))
+              && fseek(file, 0, SEEK_SET) == 0 && fwrite(&header, sizeof(header), 1, file) == 1;
+    if (!ok || fflush(file) != 0) {
+        cout << "Cannot write instance file " << path << " (" << rows << " x " << numClients << ")" << endl;
+        discard();
+        return false;
+    }
+    fclose(file);
+    file = nullptr;
+    return true;
+}
+
+// Parses every number of a CSV line into values, false if a field is not a number
+// Time Complexity: O(L), L is the length of the line
+// Space Complexity: O(1) besides values
+template <class Value>
+bool parseCsvValues(const char* begin, const char* end, vector<Value>& values)
+{
+    values.clear();
+    const char* p = begin;
+    while (true) {
+        while (p < end && (*p == ',' || *p == ';' || *p == ' ' || *p == '\t' || *p == '\r')) {
+            p++;
+        }
+        if (p == end) {
+            return true;
+        }
+        Value value;
+        from_chars_result result = from_chars(p, end, value);
+        if (result.ec != errc()) {
+            return false;
+        }
+        values.push_back(value);
+        p = result.ptr;
+    }
+}
+
+// Converts a CSV instance to the binary format, one latency row in memory at a time
+// Time Complexity: O(S * C)
+// Space Complexity: O(S + C)
+bool importCsvInstance(const string& csvPath, const string& binaryPath)
+{
+    ifstream in(csvPath, ios::binary);
+    if (!in) {
+        cout << "Cannot open CSV file " << csvPath << endl;
+        return false;
+    }
+
+    InstanceWriter writer;
+    string line;
+    vector<double> row;
+    vector<uint32_t> bandwidths;
+    vector<uint32_t> capacities;
+    bool seenBandwidth = false;
+    bool seenCapacity = false;
+    size_t numClients = 0;
+    size_t numServers = 0;
+    size_t lineNumber = 0;
+
+    while (getline(in, line)) {
+        lineNumber++;
+        const char* begin = line.data();
+        const char* end = begin + line.size();
+        while (begin < end && (*begin == ' ' || *begin == '\t' || *begin == '\r')) {
+            begin++;
+        }
+        if (begin == end || *begin == '#') {
+            continue;
+        }
+
+        bool ok;
+        if (line.compare(begin - line.data(), 9, "bandwidth") == 0) {
+            ok = parseCsvValues(begin + 9, end, bandwidths) && !bandwidths.empty();
+            seenBandwidth = true;
+        } else if (line.compare(begin - line.data(), 8, "capacity") == 0) {
+            ok = parseCsvValues(begin + 8, end, capacities) && !capacities.empty();
+            seenCapacity = true;
+        } else {
+            ok = parseCsvValues(begin, end, row) && !row.empty();
+            for (size_t j = 0; ok && j < row.size(); j++) {
+                ok = validLatency(row[j]);
+            }
+            if (ok && numServers == 0) {
+                numClients = row.size();
+                ok = writer.open(binaryPath, numClients);
+            }
+            ok = ok && row.size() == numClients && writer.writeLatencyRow(row.data());
+            numServers++;
+        }
+        if (!ok) {
+            cout << csvPath << ":" << lineNumber << ": invalid line (expected " << (numClients ? to_string(numClients) : string("some"))
+                 << " numbers, " INSTANCE_LATENCY_RULE ")" << endl;
+            return false;
+        }
+    }
+
+    if (numServers == 0 || !seenBandwidth || !seenCapacity) {
+        cout << csvPath << ": a CSV instance needs latency rows, a bandwidth line and a capacity line" << endl;
+        return false;
+    }
+    if (bandwidths.size() != numClients || capacities.size() != numServers) {
+        cout << csvPath << ": " << numServers << " x " << numClients << " latencies, but " << bandwidths.size()
+             << " bandwidths and " << capacities.size() << " capacities" << endl;
+        return false;
+    }
+    return writer.finish(bandwidths, capacities);
+}
+
+#endif
@@ -0,0 +1,329 @@
+#ifndef ISLAND_H
+#define ISLAND_H
+
+// Island model for the genetic algorithm
+// The population is split into islands that evolve on their own threads with the usual
+// selection -> variation -> evaluate -> survivor pipeline. Every MIGRATION_INTERVAL generations
+// each island sends copies of its best individuals to its neighbours, which replace their worst.
+//
+// Migration goes through bounded single-producer / single-consumer lock-free queues, one per
+// directed edge of the topology. Migrants sent at one migration are received at the next one,
+// so islands only wait for each other if one falls a whole interval behind, and the result of
+// a seed does not depend on thread timing.
+//
+// Of the stopping criteria of GAConfig, islands honour the time budget and the target fitness: the
+// first island to meet one stops every island. Stagnation and diversity are left out, migration keeps
+// feeding each island new genes, and an island stopping alone would leave its neighbours waiting.
+// The time budget makes the result depend on timing, as it does for geneticAlgorithm().
+// A GAConfig::telemetry sink receives the records of every island, tagged with the island index.
+// With GAConfig::profile, the phase times of all islands are summed (CPU time over the island threads).
+// In multi-objective mode each island runs NSGA-II and their final populations are merged into one front.
+//
+// Constants and Macros:
+// - ISLAND_COUNT: Number of islands (one thread each), each island holds GAConfig::populationSize individuals.
+// - MIGRATION_TOPOLOGY: Who sends migrants to whom (1 -> ring, 2 -> fully connected).
+// - MIGRATION_INTERVAL: Generations between two migrations.
+// - MIGRANTS: Individuals sent over each edge at every migration.
+
+#include "GeneticAlgorithm.h"
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#define ISLAND_COUNT 4
+#define MIGRATION_TOPOLOGY 1 // 1 -> ring, 2 -> fully connected
+#define MIGRATION_INTERVAL 25
+#define MIGRANTS 5
+
+using namespace std;
+
+// Settings of an island run, the defaults come from the macros above
+struct IslandConfig
+{
+    unsigned int numIslands = ISLAND_COUNT;
+    unsigned int topology = MIGRATION_TOPOLOGY;
+    unsigned int migrationInterval = MIGRATION_INTERVAL;
+    unsigned int migrants = MIGRANTS;
+};
+
+// Bounded lock-free queue of migrant genes between one sending and one receiving island
+// Slots are preallocated, pushing and popping only copy genes and move two atomic counters.
+class MigrantQueue
+{
+    private:
+    vector<Gene> slots; // capacity chromosomes back to back
+    size_t geneCount; // Genes per chromosome
+    size_t capacity; // Number of slots
+    atomic<size_t> head; // Next slot to read, only written by the consumer
+    atomic<size_t> tail; // Next slot to write, only written by the producer
+
+    public:
+    MigrantQueue(size_t capacity, size_t geneCount); // Constructor, allocates every slot.
+
+    // Methods
+    bool tryPush(const Chromosome& migrant); // Copies a migrant in, false if the queue is full.
+    bool tryPop(Chromosome& destination); // Copies a migrant out, false if the queue is empty.
+};
+
+// Constructor
+// Time Complexity: O(K * S * C), K stands for capacity
+// Space Complexity: O(K * S * C)
+MigrantQueue::MigrantQueue(size_t capacity, size_t geneCount)
+{
+    this->slots = vector<Gene>(capacity * geneCount);
+    this->geneCount = geneCount;
+    this->capacity = capacity;
+    this->head = 0;
+    this->tail = 0;
+}
+
+// Producer side: the genes are written before the new tail is published
+// Time Complexity: O(S * C)
+// Space Complexity: O(1)
+bool MigrantQueue::tryPush(const Chromosome& migrant)
+{
+    size_t currentTail = tail.load(memory_order_relaxed);
+    if (currentTail - head.load(memory_order_acquire) == capacity) {
+        return false;
+    }
+    memcpy(slots.data() + (currentTail % capacity) * geneCount, migrant.ServerAllocations, sizeof(Gene) * geneCount);
+    tail.store(currentTail + 1, memory_order_release);
+    return true;
+}
+
+// Consumer side: the migrant replaces the genes of destination, which is re-evaluated from scratch
+// Time Complexity: O(S * C)
+// Space Complexity: O(1)
+bool MigrantQueue::tryPop(Chromosome& destination)
+{
+    size_t currentHead = head.load(memory_order_relaxed);
+    if (currentHead == tail.load(memory_order_acquire)) {
+        return false;
+    }
+    memcpy(destination.ServerAllocations, slots.data() + (currentHead % capacity) * geneCount, sizeof(Gene) * geneCount);
+    destination.cacheValid = false;
+    destination.modified = true;
+    head.store(currentHead + 1, memory_order_release);
+    return true;
+}
+
+// Returns true if island `from` sends migrants to island `to` in the given topology
+// Time Complexity: O(1)
+// Space Complexity: O(1)
+bool isMigrationEdge(unsigned int from, unsigned int to, const IslandConfig& config)
+{
+    if (from == to) {
+        return false;
+    }
+    if (config.topology == 2) {
+        return true; // Fully connected
+    }
+    return to == (from + 1) % config.numIslands; // Ring
+}
+
+// Evolves one island for gaConfig.generations generations, exchanging migrants through the queues.
+// queues[from * N + to] holds the edge from island `from` to island `to` (null if not an edge).
+// The island stops early once its monitor or another island raises stop.
+// context: the frozen task shared by every island, bound to the island thread for the run
+// profiler: shared by every island, null -> not profiled
+// Time Complexity: O(G * P * S * C), G is generations, P is population size
+// Space Complexity: O(P * S * C)
+template <class Engine>
+void runIsland(unsigned int island, SolveContext& context, const IslandConfig& config, const GAConfig& gaConfig,
+               const RandomStreams& streams, vector<unique_ptr<MigrantQueue>>& queues, Population& result, mutex& logMutex,
+               ConvergenceMonitor& monitor, atomic<bool>& stop, Profiler* profiler)
+{
+    SolveScope scope(context);
+    unsigned int numIslands = config.numIslands;
+    Engine engine(streams, nullptr, gaConfig.populationSize);
+    engine.setMemetic(runMemetic(gaConfig));
+    engine.setProfiler(profiler);
+    {
+        ScopedTimer timer(profiler, PROFILE_INITIALIZATION);
+        engine.initialize(gaConfig.seedFraction);
+    }
+    Population& parentPop = engine.getPopulation();
+    if (monitor.update(parentPop, 0)) {
+        stop = true;
+    }
+
+    for (unsigned int i = 0; i < gaConfig.generations && !stop.load(memory_order_relaxed); i++) {
+        engine.step(i);
+        {
+            ScopedTimer timer(profiler, PROFILE_MONITOR);
+            if (monitor.update(parentPop, i + 1)) {
+                stop = true;
+            }
+        }
+        if (gaConfig.telemetry && gaConfig.telemetry->takeDumpRequest()) {
+            lock_guard<mutex> lock(logMutex); // The first island to see the request prints its best
+            cout << "Island " << island + 1 << " Generation " << i + 1 << " Current Best: " << endl;
+            printIndividual(engine.best());
+        }
+
+        if ((i + 1) % config.migrationInterval != 0) {
+            continue;
+        }
+        unsigned int epoch = (i + 1) / config.migrationInterval;
+        vector<Chromosome>& views = parentPop.individuals;
+        size_t migrants = min<size_t>(config.migrants, views.size() / 2);
+
+        // Send: best individuals to the front
+        partial_sort(views.begin(), views.begin() + migrants, views.end(), compareByFitness);
+        for (unsigned int to = 0; to < numIslands; to++) {
+            MigrantQueue* queue = queues[island * numIslands + to].get();
+            for (size_t m = 0; queue && m < migrants; m++) {
+                while (!queue->tryPush(views[m]) && !stop.load(memory_order_relaxed)) {
+                    this_thread::yield(); // The receiver is a whole interval behind
+                }
+            }
+        }
+
+        // Receive the migrants sent at the previous migration, they replace the worst individuals
+        if (epoch < 2) {
+            continue;
+        }
+        size_t replaced = 0;
+        size_t incomingEdges = 0;
+        for (unsigned int from = 0; from < numIslands; from++) {
+            incomingEdges += queues[from * numIslands + island] != nullptr;
+        }
+        size_t slotsToFill = min(incomingEdges * migrants, views.size() - migrants);
+        nth_element(views.begin() + migrants, views.end() - slotsToFill, views.end(), compareByFitness);
+        for (unsigned int from = 0; from < numIslands; from++) {
+            MigrantQueue* queue = queues[from * numIslands + island].get();
+            for (size_t m = 0; queue && m < migrants; m++) {
+                Chromosome& worst = views[views.size() - 1 - (replaced % slotsToFill)];
+                while (!queue->tryPop(worst) && !stop.load(memory_order_relaxed)) {
+                    this_thread::yield(); // The sender has not reached this migration yet (or stopped)
+                }
+                engine.evaluateOne(worst);
+                replaced++;
+            }
+        }
+
+        if (gaConfig.verbose) {
+            lock_guard<mutex> lock(logMutex);
+            cout << "Island " << island + 1 << " Generation " << i + 1 << " Best Fitness = " << views[0].fitness << endl;
+        }
+    }
+
+    result = move(parentPop);
+}
+
+// Island model genetic algorithm, the operators of every island are picked by gaConfig
+// Every island gets its own family of random streams forked from the seed, so a seed always gives
+// the same result, and islands share only the frozen task and the migration queues.
+// gaConfig.numThreads is not used: each island runs serially on its own thread.
+// Time Complexity: O(G * N * P * S * C / T), N is the number of islands, T = min(N, cores)
+// Space Complexity: O(N * P * S * C + E * MIGRANTS * S * C), E is the number of edges of the topology
+void islandGeneticAlgorithm(Task task1, const GAConfig& gaConfig, IslandConfig config) {
+    config.numIslands = max(1u, config.numIslands);
+    GAConfig stopConfig = gaConfig; // Criteria every island can apply on its own
+    stopConfig.stagnationGenerations = 0;
+    stopConfig.minDiversity = 0;
+    BestSolution ownBest;
+    BestSolution* sharedBest = gaConfig.bestSolution ? gaConfig.bestSolution : &ownBest;
+    vector<unique_ptr<ConvergenceMonitor>> monitors;
+    for (unsigned int k = 0; k < config.numIslands; k++) {
+        monitors.emplace_back(new ConvergenceMonitor(stopConfig, sharedBest, k)); // Starts the clock of timeBudget
+    }
+    atomic<bool> stop(false);
+
+    SolveContext context; // Shared by the island threads, each one binds it
+    context.task = move(task1);
+    context.task.freeze();
+    SolveScope scope(context);
+    findUpperBound();
+    config.migrationInterval = max(1u, config.migrationInterval);
+    if(gaConfig.verbose){
+        cout << "Seed = " << gaConfig.seed << ", Islands = " << config.numIslands << endl;
+    }
+
+    // Two migrations worth of slots per edge: a sender may be one interval ahead of its receiver
+    unsigned int numIslands = config.numIslands;
+    size_t geneCount = context.task.getNumGenes();
+    vector<unique_ptr<MigrantQueue>> queues(numIslands * numIslands);
+    for (unsigned int from = 0; from < numIslands; from++) {
+        for (unsigned int to = 0; to < numIslands; to++) {
+            if (isMigrationEdge(from, to, config)) {
+                queues[from * numIslands + to].reset(new MigrantQueue(2 * max(1u, config.migrants), geneCount));
+            }
+        }
+    }
+
+    RandomStreams streams(gaConfig.seed);
+    vector<Population> results(numIslands);
+    vector<RandomStreams> islandStreams;
+    for (unsigned int k = 0; k < numIslands; k++) {
+        islandStreams.push_back(streams.fork(k));
+    }
+    mutex logMutex;
+    Profiler profiler; // Phase times are summed over the islands
+    vector<thread> threads;
+    dispatchEngine(gaConfig, [&](auto tag) {
+        for (unsigned int k = 0; k < numIslands; k++) {
+            threads.emplace_back(runIsland<typename decltype(tag)::type>, k, ref(context), cref(config), cref(gaConfig),
+                                 cref(islandStreams[k]), ref(queues), ref(results[k]), ref(logMutex),
+                                 ref(*monitors[k]), ref(stop), gaConfig.profile ? &profiler : nullptr);
+        }
+    });
+    for (thread& islandThread : threads) {
+        islandThread.join();
+    }
+    if (gaConfig.verbose && stop) {
+        for (auto& monitor : monitors) {
+            if (monitor->stopReason() != STOP_GENERATIONS) {
+                cout << "Stopped (" << stopReasonName(monitor->stopReason()) << ") in " << monitor->elapsed() << " s" << endl;
+                break;
+            }
+        }
+    }
+
+    // Best individual over all islands, feasible first
+    Chromosome* best = nullptr;
+    for (Population& islandPop : results) {
+        for (Chromosome& individual : islandPop.individuals) {
+            if (!best || betterSolution(individual.fitness, individual.isFeas, best->fitness, best->isFeas)) {
+                best = &individual;
+            }
+        }
+    }
+    if (gaConfig.printBest) {
+        cout << "Best: " << endl;
+        printIndividual(*best);
+        cout << "Fitness = " << best->fitness << endl;
+    }
+    if (gaConfig.multiObjective) {
+        // Fronts of the islands merged into one non-dominated set
+        vector<const Chromosome*> candidates;
+        for (Population& islandPop : results) {
+            for (Chromosome& individual : islandPop.individuals) {
+                candidates.push_back(&individual);
+            }
+        }
+        vector<SolutionSnapshot> front;
+        collectParetoFront(candidates, front);
+        if (gaConfig.printBest) {
+            printParetoFront(front);
+        }
+        if (gaConfig.paretoFront) {
+            *gaConfig.paretoFront = move(front);
+        }
+    }
+    if (gaConfig.profile) {
+        profiler.report(monitors[0]->elapsed());
+    }
+}
+
+// Island model genetic algorithm with the operators selected by the macros
+// Time Complexity: O(G * N * P * S * C / T)
+// Space Complexity: O(N * P * S * C)
+void islandGeneticAlgorithm(Task task1, uint64_t seed = time(NULL), IslandConfig config = IslandConfig()) {
+    GAConfig gaConfig;
+    gaConfig.seed = seed;
+    islandGeneticAlgorithm(task1, gaConfig, config);
+}
+
+#endif
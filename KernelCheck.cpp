@@ -0,0 +1,174 @@
+// Checks the fitness kernels against the scalar reference evaluation
+// Every kernel the CPU supports (scalar, AVX2, AVX-512) evaluates the same random individuals on dense
+// instances whose client counts are and are not multiples of 4 and 8, with zero genes mixed in and one
+// all-zero individual per instance. Latency score, server loads, client loads, zero count, overload
+// counts and the three penalties of each kernel are compared with calculateLatencyScore() and
+// calculatePenalty(). The kernels are compiled for one GENE_TYPE, so build and run it once per type:
+//   for t in 0 1 2 3; do g++ -std=c++17 -O2 -pthread -DGENE_TYPE=$t KernelCheck.cpp -o KernelCheck && ./KernelCheck || break; done
+// Exits with 1 at the first mismatch, after printing it, and with 0 when every kernel agrees.
+//
+// Constants and Macros:
+// - CHECK_INDIVIDUALS: Random individuals evaluated per instance.
+// - CHECK_TOLERANCE: Largest relative difference accepted on the sums, scores and penalties.
+
+#include "GeneticAlgorithm.h"
+#include <cmath>
+#include <iostream>
+
+#define CHECK_INDIVIDUALS 20
+#define CHECK_TOLERANCE 1e-9
+
+using namespace std;
+
+SolveContext checkContext; // Instance being checked, bound to the main thread by main()
+
+// Builds a dense task with random latencies into checkContext, capacities and bandwidths are tight
+// enough that random individuals overload some servers and clients but not all of them
+// Time Complexity: O(S * C)
+// Space Complexity: O(S * C)
+void setupCheckInstance(unsigned int numServers, unsigned int numClients, Rng& rng)
+{
+    vector<vector<double>> latencies(numServers, vector<double>(numClients));
+    for (unsigned int i = 0; i < numServers; i++) {
+        for (unsigned int j = 0; j < numClients; j++) {
+            latencies[i][j] = 1.0 + 49.0 * rng.uniform();
+        }
+    }
+    Task& task = checkContext.task;
+    task = Task(numServers, numClients, latencies);
+    for (unsigned int j = 0; j < numClients; j++) {
+        task.setBandwith(j, 10 + rng.bounded(40));
+    }
+    for (unsigned int i = 0; i < numServers; i++) {
+        task.setCapacity(i, 1 + rng.bounded(25 * numClients));
+    }
+    task.freeze();
+    findUpperBound();
+}
+
+// True if value is within CHECK_TOLERANCE of reference, relative to scale or to the reference if larger
+// Time Complexity: O(1)
+// Space Complexity: O(1)
+bool closeTo(double value, double reference, double scale = 1.0)
+{
+    return fabs(value - reference) <= CHECK_TOLERANCE * max(scale, fabs(reference));
+}
+
+// Prints a mismatch and returns false
+// Time Complexity: O(1)
+// Space Complexity: O(1)
+bool reportMismatch(const char* kernelName, const Chromosome& indi, unsigned int individual, const char* field,
+                    double value, double reference)
+{
+    cout << "FAIL " << kernelName << " " << indi.numServers << " x " << indi.numClients << " individual "
+         << individual << ": " << field << " " << setprecision(17) << value << " instead of " << reference << endl;
+    return false;
+}
+
+// Evaluates indi with kernel and compares every output with the scalar reference evaluation
+// Time Complexity: O(S * C)
+// Space Complexity: O(S + C)
+bool checkKernel(FitnessKernel kernel, Chromosome& indi, unsigned int individual)
+{
+    const char* name = fitnessKernelName(kernel);
+    Chromosome reference = indi;
+    calculateLatencyScore(reference);
+    calculatePenalty(reference);
+
+    vector<double> serverSums(indi.numServers, NAN);
+    vector<double> clientSums(indi.numClients, NAN); // NaN catches sums the kernel does not overwrite
+    unsigned int zeroCount = ~0u;
+    kernel(indi.ServerAllocations, checkContext.task.getIdealAllocations(), checkContext.task.getLatencyTotals(),
+           indi.numServers, indi.numClients, serverSums.data(), clientSums.data(), &indi.latencyScore, &zeroCount);
+    penaltiesFromSums(indi, serverSums.data(), clientSums.data(), zeroCount);
+
+    if (!closeTo(indi.latencyScore, reference.latencyScore)) {
+        return reportMismatch(name, indi, individual, "latency score", indi.latencyScore, reference.latencyScore);
+    }
+    for (unsigned int i = 0; i < indi.numServers; i++) {
+        double load = 0;
+        for (unsigned int j = 0; j < indi.numClients; j++) {
+            load += indi.ServerAllocations[(size_t)i * indi.numClients + j];
+        }
+        if (!closeTo(serverSums[i], load)) {
+            return reportMismatch(name, indi, individual, "server load", serverSums[i], load);
+        }
+    }
+    for (unsigned int j = 0; j < indi.numClients; j++) {
+        double load = 0;
+        for (unsigned int i = 0; i < indi.numServers; i++) {
+            load += indi.ServerAllocations[(size_t)i * indi.numClients + j];
+        }
+        if (!closeTo(clientSums[j], load)) {
+            return reportMismatch(name, indi, individual, "client load", clientSums[j], load);
+        }
+    }
+    if (indi.zeroCount != reference.zeroCount) {
+        return reportMismatch(name, indi, individual, "zero count", indi.zeroCount, reference.zeroCount);
+    }
+    if (indi.overloadedServers != reference.overloadedServers) {
+        return reportMismatch(name, indi, individual, "overloaded servers", indi.overloadedServers, reference.overloadedServers);
+    }
+    if (indi.overloadedClients != reference.overloadedClients) {
+        return reportMismatch(name, indi, individual, "overloaded clients", indi.overloadedClients, reference.overloadedClients);
+    }
+    // Penalties are PENALTY_CONSTANT times an excess, the rounding of the excess is scaled by it
+    if (!closeTo(indi.penaltyCapacity, reference.penaltyCapacity, PENALTY_CONSTANT)) {
+        return reportMismatch(name, indi, individual, "capacity penalty", indi.penaltyCapacity, reference.penaltyCapacity);
+    }
+    if (!closeTo(indi.penaltyBandwith, reference.penaltyBandwith, PENALTY_CONSTANT)) {
+        return reportMismatch(name, indi, individual, "bandwidth penalty", indi.penaltyBandwith, reference.penaltyBandwith);
+    }
+    if (indi.connectionPen != reference.connectionPen) {
+        return reportMismatch(name, indi, individual, "connection penalty", indi.connectionPen, reference.connectionPen);
+    }
+    return true;
+}
+
+int main()
+{
+    unsigned int serverCounts[] = {1, 3, 8, 17};
+    unsigned int clientCounts[] = {1, 2, 3, 4, 5, 7, 8, 9, 12, 15, 16, 17, 31, 33, 100, 257};
+
+    vector<FitnessKernel> kernels = {fitnessKernelScalar};
+#ifdef FITNESS_KERNELS_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        kernels.push_back(fitnessKernelAvx2);
+    } else {
+        cout << "avx2 not supported by this CPU, skipped" << endl;
+    }
+    if (__builtin_cpu_supports("avx512f")) {
+        kernels.push_back(fitnessKernelAvx512);
+    } else {
+        cout << "avx512 not supported by this CPU, skipped" << endl;
+    }
+#endif
+
+    SolveScope scope(checkContext);
+    Rng rng(2024);
+    unsigned long long checks = 0;
+    for (unsigned int numServers : serverCounts) {
+        for (unsigned int numClients : clientCounts) {
+            setupCheckInstance(numServers, numClients, rng);
+            Population pop(CHECK_INDIVIDUALS, numServers, numClients);
+            for (unsigned int k = 0; k < pop.size(); k++) {
+                generateIndividual(pop[k], rng);
+                for (unsigned int g = 0; g < pop[k].numGenes; g++) {
+                    if (k == 0 || rng.bounded(4) == 0) {
+                        pop[k].ServerAllocations[g] = toGene(0); // Individual 0 is all zeros
+                    }
+                }
+                for (FitnessKernel kernel : kernels) {
+                    if (!checkKernel(kernel, pop[k], k)) {
+                        return 1;
+                    }
+                    checks++;
+                }
+            }
+        }
+    }
+
+    cout << "GENE_TYPE " << GENE_TYPE << ": " << kernels.size() << " kernels agree on " << checks << " evaluations" << endl;
+    return 0;
+}
@@ -1,10 +1,135 @@
-#include "GeneticAlgorithm.h"
+#include "SolverDaemon.h"
+#include "Decomposition.h"
+#include <chrono>
+#include <csignal>
+#include <fstream>
 #include <iostream>
+#include <sstream>
+#include <memory>
 #include <vector>
 
 using namespace std;
 
-int main()
+// Sink of --telemetry, reached by the SIGUSR1 handler to request a dump of the best solution
+TelemetrySink* activeTelemetry = nullptr;
+
+// SIGUSR1 handler: only sets an atomic flag, the solver prints after its current generation
+void requestDumpSignal(int)
+{
+    if (activeTelemetry) {
+        activeTelemetry->requestDump();
+    }
+}
+
+// Prints the command line usage
+// Time Complexity: O(1)
+// Space Complexity: O(1)
+void printUsage(const char* program)
+{
+    cout << "Usage:" << endl;
+    cout << "  " << program << "                               interactive 4 x 6 example" << endl;
+    cout << "  " << program << " <instance.bin> [options]      solve a binary instance file" << endl;
+    cout << "  " << program << " --import <in.csv> <out.bin>   convert a CSV instance (see InstanceFile.h)" << endl;
+    cout << "  " << program << " --serve <socket> [options]    solver daemon on a Unix socket (see SolverDaemon.h)," << endl;
+    cout << "                                    the options are the defaults of every request" << endl;
+    cout << "  " << program << " --batch <list.txt> [options]  solve many instances at once (see BatchSolver.h), the list" << endl;
+    cout << "                                    holds one instance path per line, optionally followed by its" << endl;
+    cout << "                                    time budget in seconds; --threads is the number of workers" << endl;
+    cout << "Options:" << endl;
+    cout << "  --seed N          random seed (default: time)" << endl;
+    cout << "  --threads N       worker threads, 0 -> all hardware threads" << endl;
+    cout << "  --generations N   number of generations" << endl;
+    cout << "  --population N    individuals per generation" << endl;
+    cout << "  --crossover N     1 -> BLX-alpha, 2 -> SBX" << endl;
+    cout << "  --no-elitism      generational survivor selection" << endl;
+    cout << "  --penalty N       1 -> static, 2 -> generation-scheduled, 3 -> adaptive to the feasible ratio" << endl;
+    cout << "  --repair          repair infeasible offspring instead of only penalizing them" << endl;
+    cout << "  --no-repair       only penalize infeasible offspring (the default unless built with REPAIR_OFFSPRING)" << endl;
+    cout << "  --local-search N  polish the N best individuals by local search every generation, 0 -> off (default)" << endl;
+    cout << "  --time-budget S   wall-clock budget in seconds, 0 -> no deadline" << endl;
+    cout << "  --stagnation N    stop after N generations without improvement, 0 -> never" << endl;
+    cout << "  --target F        stop once the best fitness is at or below F" << endl;
+    cout << "  --min-diversity D stop once the population diversity falls below D, 0 -> never" << endl;
+    cout << "  --seed-fraction F share of the initial population built by heuristics, 0 -> random" << endl;
+    cout << "  --telemetry PATH  write per-generation statistics to PATH (CSV if it ends in .csv, else JSONL);" << endl;
+    cout << "                    kill -USR1 prints the current best solution" << endl;
+    cout << "  --profile         print the time spent in each phase at the end of the run" << endl;
+    cout << "  --multi-objective NSGA-II on latency, load imbalance and violation, prints the Pareto front" << endl;
+    cout << "  --decompose K     split the instance into K clusters solved in parallel, then reconcile them" << endl;
+    cout << "                    (see Decomposition.h), 0 -> number of clusters picked from the instance size" << endl;
+    cout << "  --quiet           only print the best solution" << endl;
+}
+
+// Parses the options that follow the instance path into a GA configuration
+// Time Complexity: O(A), A stands for the number of arguments
+// Space Complexity: O(1)
+// telemetryPath: receives the value of --telemetry (empty -> no telemetry)
+// decompose, decomposition: set by --decompose
+bool parseOptions(int argc, char** argv, int first, GAConfig& config, string& telemetryPath,
+                  bool& decompose, DecompositionConfig& decomposition)
+{
+    for (int i = first; i < argc; i++) {
+        string option = argv[i];
+        if (option == "--no-elitism") {
+            config.elitism = false;
+        } else if (option == "--quiet") {
+            config.verbose = false;
+        } else if (option == "--profile") {
+            config.profile = true;
+        } else if (option == "--multi-objective") {
+            config.multiObjective = true;
+        } else if (option == "--repair") {
+            config.memetic.repairOffspring = true;
+        } else if (option == "--no-repair") {
+            config.memetic.repairOffspring = false;
+        } else if (i + 1 < argc) {
+            const char* text = argv[++i];
+            unsigned long long value = strtoull(text, nullptr, 10);
+            if (option == "--seed") {
+                config.seed = value;
+            } else if (option == "--threads") {
+                config.numThreads = value;
+            } else if (option == "--generations") {
+                config.generations = value;
+            } else if (option == "--population") {
+                config.populationSize = value;
+            } else if (option == "--crossover") {
+                config.crossoverMethod = value;
+            } else if (option == "--penalty") {
+                config.penaltyMethod = value;
+            } else if (option == "--time-budget") {
+                config.timeBudget = strtod(text, nullptr);
+            } else if (option == "--stagnation") {
+                config.stagnationGenerations = value;
+            } else if (option == "--target") {
+                config.targetFitness = strtod(text, nullptr);
+            } else if (option == "--min-diversity") {
+                config.minDiversity = strtod(text, nullptr);
+            } else if (option == "--seed-fraction") {
+                config.seedFraction = strtod(text, nullptr);
+            } else if (option == "--local-search") {
+                config.memetic.localSearchElites = value;
+            } else if (option == "--telemetry") {
+                telemetryPath = text;
+            } else if (option == "--decompose") {
+                decompose = true;
+                decomposition.numClusters = value;
+            } else {
+                cout << "Unknown option " << option << endl;
+                return false;
+            }
+        } else {
+            cout << "Missing value for option " << option << endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+// Original interactive example: a fixed latency matrix, bandwidths and capacities typed by the user
+// Time Complexity: O(S + C) for the input, plus the genetic algorithm
+// Space Complexity: O(S * C)
+void runInteractiveExample()
 {
     const unsigned int numClients = 6; //Specify client number
     const unsigned int numServers = 4; //Specify server number
@@ -29,20 +154,140 @@ int main()
         cout << "Enter Bandwith of Client "<<i+1<< endl;
         cout << "(Do not enter 0 or negative values!)" << endl;
         cin >> a;
-        task1.setBandwith(i, a);    
+        task1.setBandwith(i, a);
     }
-    
+
         //Takes input from user for each clients TC: O(n) SC:(n) n number of servers
     for(int i = 0; i<numServers; i++){
         int a;
         cout << "Enter Capacity of Server "<<i+1 << endl;
         cout << "(Do not enter 0 or negative values!)" << endl;
         cin >> a;
-        task1.setCapacity(i, a);    
+        task1.setCapacity(i, a);
     }
 
     //Genetic Algorithm main5
     geneticAlgorithm(task1);
-    
+}
+
+// Solves every instance named in a list file with solveBatch() and prints one line per instance
+// Time Complexity: O(L + J log J) plus the solves, L stands for the characters of the list
+// Space Complexity: O(J * S * C)
+bool runBatchFile(const char* listPath, const GAConfig& config)
+{
+    ifstream list(listPath);
+    if (!list) {
+        cout << "Cannot open " << listPath << endl;
+        return false;
+    }
+    vector<string> paths;
+    vector<BatchJob> jobs;
+    string line;
+    while (getline(list, line)) {
+        istringstream fields(line);
+        string path;
+        if (!(fields >> path) || path[0] == '#') {
+            continue; // Blank line or comment
+        }
+        BatchJob job;
+        fields >> job.timeBudget;
+        if (!job.task.loadInstance(path)) {
+            return false;
+        }
+        paths.push_back(path);
+        jobs.push_back(move(job));
+    }
+
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    vector<BatchResult> results = solveBatch(jobs, config, config.numThreads);
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    for (size_t k = 0; k < results.size(); k++) {
+        cout << paths[k] << ": Fitness = " << results[k].best.fitness << " LatencyScore = " << results[k].best.latencyScore
+             << (results[k].best.isFeas ? " feasible" : " infeasible") << ", seed " << results[k].seed << ", "
+             << results[k].seconds << " s on worker " << results[k].worker << endl;
+    }
+    cout << results.size() << " instances in " << seconds << " s (" << (seconds > 0 ? results.size() / seconds : 0)
+         << " instances/s)" << endl;
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    if (argc == 1) {
+        runInteractiveExample();
+        return 0;
+    }
+
+    string first = argv[1];
+    if (first == "--help" || first == "-h") {
+        printUsage(argv[0]);
+        return 0;
+    }
+    if (first == "--import") {
+        if (argc != 4) {
+            printUsage(argv[0]);
+            return 1;
+        }
+        return importCsvInstance(argv[2], argv[3]) ? 0 : 1;
+    }
+
+    GAConfig config;
+    string telemetryPath;
+    bool decompose = false;
+    DecompositionConfig decomposition;
+    bool serve = first == "--serve";
+    bool batch = first == "--batch";
+    if (((serve || batch) && argc < 3) || !parseOptions(argc, argv, serve || batch ? 3 : 2, config, telemetryPath, decompose, decomposition)) {
+        printUsage(argv[0]);
+        return 1;
+    }
+    if (batch) {
+        return runBatchFile(argv[2], config) ? 0 : 1;
+    }
+    if (serve) {
+#ifdef _WIN32
+        cout << "The solver daemon needs Unix domain sockets" << endl;
+        return 1;
+#else
+        SolverDaemon daemon(config);
+        if (!daemon.listen(argv[2])) {
+            return 1;
+        }
+        cout << "Listening on " << argv[2] << endl;
+        daemon.serve();
+        return 0;
+#endif
+    }
+    unique_ptr<TelemetrySink> telemetry;
+    if (!telemetryPath.empty()) {
+        bool csv = telemetryPath.size() >= 4 && telemetryPath.compare(telemetryPath.size() - 4, 4, ".csv") == 0;
+        telemetry.reset(new TelemetrySink(telemetryPath, csv ? TELEMETRY_CSV : TELEMETRY_JSONL));
+        if (!telemetry->isOpen()) {
+            return 1;
+        }
+        config.telemetry = telemetry.get();
+        activeTelemetry = telemetry.get();
+        signal(SIGUSR1, requestDumpSignal);
+    }
+
+    // Loading only maps the file, the latencies are paged in by freeze() inside the solver
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    Task task1;
+    if (!task1.loadInstance(first)) {
+        return 1;
+    }
+    if (config.verbose) {
+        cout << "Loaded " << task1.getNumServers() << " x " << task1.getNumClients() << " instance in "
+             << chrono::duration<double, milli>(chrono::steady_clock::now() - start).count() << " ms" << endl;
+    }
+
+    if (decompose) {
+        decomposedGeneticAlgorithm(task1, config, decomposition);
+    } else {
+        geneticAlgorithm(task1, config);
+    }
+    if (telemetry && telemetry->dropped()) {
+        cout << "Telemetry dropped " << telemetry->dropped() << " records" << endl;
+    }
     return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,299 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+// Per-phase profiling of the genetic algorithm
+// The engine wraps each phase of a generation in a ScopedTimer and bumps event counters (kernel
+// evaluations, repairs, ...) on the Profiler it was given. Without a profiler every hook is a null
+// check, and with PROFILING 0 the hooks compile to nothing at all.
+// Phases are wall-clock time of the calling thread, so the parallel parts count once however many
+// workers run them. Crossover and mutation run inside variation on the workers, their times are
+// summed over the workers (CPU time) and can exceed the variation phase.
+//
+// Constants and Macros:
+// - PROFILING: 1 -> hooks compiled in, enabled at runtime by GAConfig::profile, 0 -> compiled out.
+// - PROFILE_ALLOCATIONS: 1 -> replaces every global operator new / delete to count heap allocations
+//   (the program must be a single translation unit, as every program of this repository is).
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+
+#ifndef PROFILING
+#define PROFILING 1
+#endif
+#ifndef PROFILE_ALLOCATIONS
+#define PROFILE_ALLOCATIONS 0
+#endif
+
+using namespace std;
+
+// Heap allocations of the whole program, only counted with PROFILE_ALLOCATIONS
+atomic<unsigned long long> profileAllocationCount(0);
+
+#if PROFILE_ALLOCATIONS
+// Every form of the global operator new goes through here, every operator delete frees with free(),
+// so any new / delete pairing the compiler sees stays consistent. Returns nullptr when out of memory.
+// Time Complexity: O(1) plus the cost of malloc
+// Space Complexity: O(size)
+void* profiledAllocate(size_t size, size_t alignment = 0)
+{
+    profileAllocationCount.fetch_add(1, memory_order_relaxed);
+    size = size ? size : 1;
+    if (alignment <= __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+        return malloc(size);
+    }
+    return aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment); // Size must be a multiple
+}
+
+// Throwing forms: bad_alloc when the allocation fails
+// Time Complexity: O(1) plus the cost of malloc
+// Space Complexity: O(size)
+void* profiledAllocateOrThrow(size_t size, size_t alignment = 0)
+{
+    void* memory = profiledAllocate(size, alignment);
+    if (!memory) {
+        throw bad_alloc();
+    }
+    return memory;
+}
+
+void* operator new(size_t size) { return profiledAllocateOrThrow(size); }
+void* operator new[](size_t size) { return profiledAllocateOrThrow(size); }
+void* operator new(size_t size, const nothrow_t&) noexcept { return profiledAllocate(size); }
+void* operator new[](size_t size, const nothrow_t&) noexcept { return profiledAllocate(size); }
+void* operator new(size_t size, align_val_t alignment) { return profiledAllocateOrThrow(size, (size_t)alignment); }
+void* operator new[](size_t size, align_val_t alignment) { return profiledAllocateOrThrow(size, (size_t)alignment); }
+void* operator new(size_t size, align_val_t alignment, const nothrow_t&) noexcept { return profiledAllocate(size, (size_t)alignment); }
+void* operator new[](size_t size, align_val_t alignment, const nothrow_t&) noexcept { return profiledAllocate(size, (size_t)alignment); }
+
+void operator delete(void* memory) noexcept { free(memory); }
+void operator delete[](void* memory) noexcept { free(memory); }
+void operator delete(void* memory, size_t) noexcept { free(memory); }
+void operator delete[](void* memory, size_t) noexcept { free(memory); }
+void operator delete(void* memory, const nothrow_t&) noexcept { free(memory); }
+void operator delete[](void* memory, const nothrow_t&) noexcept { free(memory); }
+void operator delete(void* memory, align_val_t) noexcept { free(memory); }
+void operator delete[](void* memory, align_val_t) noexcept { free(memory); }
+void operator delete(void* memory, size_t, align_val_t) noexcept { free(memory); }
+void operator delete[](void* memory, size_t, align_val_t) noexcept { free(memory); }
+void operator delete(void* memory, align_val_t, const nothrow_t&) noexcept { free(memory); }
+void operator delete[](void* memory, align_val_t, const nothrow_t&) noexcept { free(memory); }
+#endif
+
+// Timed phases of a run
+enum ProfilePhase
+{
+    PROFILE_INITIALIZATION, // Initial population and its evaluation
+    PROFILE_SELECTION, // Selection and the copy of the parents into the offspring buffer
+    PROFILE_VARIATION, // Crossover and mutation of every pair
+    PROFILE_CROSSOVER, // Part of variation, summed over the workers
+    PROFILE_MUTATION, // Part of variation, summed over the workers
+    PROFILE_EVALUATE, // Evaluation of the offspring
+    PROFILE_REPAIR, // Repair of the infeasible offspring and their re-evaluation
+    PROFILE_SURVIVOR, // Survivor selection
+    PROFILE_LOCAL_SEARCH, // Local search on the elites
+    PROFILE_MONITOR, // Stopping criteria and telemetry
+    PROFILE_PHASES
+};
+
+// Counted events of a run
+enum ProfileCounter
+{
+    PROFILE_GENERATIONS,
+    PROFILE_KERNEL_EVALUATIONS, // Individuals that went through the fitness kernel
+    PROFILE_MEMO_HITS, // Duplicates that copied the evaluation of an identical individual
+    PROFILE_RECOMBINED, // Individuals whose cached scores only needed a new fitness
+    PROFILE_INFEASIBLE, // Infeasible offspring after evaluation
+    PROFILE_REPAIRED, // Offspring passed to repairIndividual()
+    PROFILE_COUNTERS
+};
+
+// Accumulates phase times and event counts, may be shared by several engines (islands)
+class Profiler
+{
+    private:
+    atomic<unsigned long long> phaseNs[PROFILE_PHASES];
+    atomic<unsigned long long> phaseCalls[PROFILE_PHASES];
+    atomic<unsigned long long> counters[PROFILE_COUNTERS];
+    unsigned long long allocationsAtStart;
+
+    public:
+    Profiler(); // Constructor, every total starts at 0.
+
+    // Methods
+    void addTime(ProfilePhase phase, unsigned long long ns, unsigned long long calls = 1); // Adds to the time of a phase.
+    void count(ProfileCounter counter, unsigned long long amount = 1); // Adds to an event counter.
+    unsigned long long time(ProfilePhase phase) const; // Nanoseconds spent in a phase.
+    unsigned long long calls(ProfilePhase phase) const; // Number of timed calls of a phase.
+    unsigned long long counter(ProfileCounter counter) const; // Value of an event counter.
+    unsigned long long allocations() const; // Heap allocations since construction (0 without PROFILE_ALLOCATIONS).
+    void report(double seconds) const; // Prints the summary, seconds is the wall-clock time of the run.
+};
+
+// Name of a phase in the report
+// Time Complexity: O(1)
+// Space Complexity: O(1)
+const char* profilePhaseName(ProfilePhase phase)
+{
+    switch (phase) {
+        case PROFILE_INITIALIZATION: return "initialization";
+        case PROFILE_SELECTION: return "selection";
+        case PROFILE_VARIATION: return "variation";
+        case PROFILE_CROSSOVER: return "  crossover (cpu)";
+        case PROFILE_MUTATION: return "  mutation (cpu)";
+        case PROFILE_EVALUATE: return "evaluate";
+        case PROFILE_REPAIR: return "repair";
+        case PROFILE_SURVIVOR: return "survivor";
+        case PROFILE_LOCAL_SEARCH: return "local search";
+        case PROFILE_MONITOR: return "monitor";
+        default: return "unknown";
+    }
+}
+
+// Monotonic clock in nanoseconds
+// Time Complexity: O(1)
+// Space Complexity: O(1)
+unsigned long long profileClock()
+{
+    return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Constructor
+// Time Complexity: O(1)
+// Space Complexity: O(1)
+Profiler::Profiler()
+{
+    for (int p = 0; p < PROFILE_PHASES; p++) {
+        phaseNs[p] = 0;
+        phaseCalls[p] = 0;
+    }
+    for (int c = 0; c < PROFILE_COUNTERS; c++) {
+        counters[c] = 0;
+    }
+    allocationsAtStart = profileAllocationCount.load(memory_order_relaxed);
+}
+
+// Time Complexity: O(1)
+// Space Complexity: O(1)
+void Profiler::addTime(ProfilePhase phase, unsigned long long ns, unsigned long long calls)
+{
+    phaseNs[phase].fetch_add(ns, memory_order_relaxed);
+    phaseCalls[phase].fetch_add(calls, memory_order_relaxed);
+}
+
+// Time Complexity: O(1)
+// Space Complexity: O(1)
+void Profiler::count(ProfileCounter counter, unsigned long long amount)
+{
+    counters[counter].fetch_add(amount, memory_order_relaxed);
+}
+
+// Time Complexity: O(1)
+// Space Complexity: O(1)
+unsigned long long Profiler::time(ProfilePhase phase) const
+{
+    return phaseNs[phase].load(memory_order_relaxed);
+}
+
+// Time Complexity: O(1)
+// Space Complexity: O(1)
+unsigned long long Profiler::calls(ProfilePhase phase) const
+{
+    return phaseCalls[phase].load(memory_order_relaxed);
+}
+
+// Time Complexity: O(1)
+// Space Complexity: O(1)
+unsigned long long Profiler::counter(ProfileCounter counter) const
+{
+    return counters[counter].load(memory_order_relaxed);
+}
+
+// Time Complexity: O(1)
+// Space Complexity: O(1)
+unsigned long long Profiler::allocations() const
+{
+    return profileAllocationCount.load(memory_order_relaxed) - allocationsAtStart;
+}
+
+// One line per phase (total, share of the run, calls, mean per call), then the counters per generation
+// Time Complexity: O(1)
+// Space Complexity: O(1)
+void Profiler::report(double seconds) const
+{
+    if (!PROFILING) {
+        cout << "Profiling was compiled out (PROFILING 0)" << endl;
+        return;
+    }
+    unsigned long long generations = counter(PROFILE_GENERATIONS);
+    double perGeneration = generations ? 1.0 / generations : 0;
+    char line[160];
+    cout << "Profile of " << generations << " generations in " << seconds << " s:" << endl;
+    snprintf(line, sizeof(line), "  %-20s %12s %8s %10s %12s", "phase", "total ms", "% run", "calls", "us/call");
+    cout << line << endl;
+    for (int p = 0; p < PROFILE_PHASES; p++) {
+        ProfilePhase phase = (ProfilePhase)p;
+        if (!calls(phase)) {
+            continue;
+        }
+        double ms = time(phase) * 1e-6;
+        snprintf(line, sizeof(line), "  %-20s %12.3f %8.2f %10llu %12.3f", profilePhaseName(phase), ms,
+                 seconds > 0 ? ms / (10 * seconds) : 0, calls(phase), ms * 1e3 / calls(phase));
+        cout << line << endl;
+    }
+    snprintf(line, sizeof(line), "  kernel evaluations %llu (%.1f per generation), memo hits %llu, recombined only %llu",
+             counter(PROFILE_KERNEL_EVALUATIONS), counter(PROFILE_KERNEL_EVALUATIONS) * perGeneration,
+             counter(PROFILE_MEMO_HITS), counter(PROFILE_RECOMBINED));
+    cout << line << endl;
+    snprintf(line, sizeof(line), "  infeasible offspring %llu (%.1f per generation), repaired %llu",
+             counter(PROFILE_INFEASIBLE), counter(PROFILE_INFEASIBLE) * perGeneration, counter(PROFILE_REPAIRED));
+    cout << line << endl;
+    if (PROFILE_ALLOCATIONS) {
+        snprintf(line, sizeof(line), "  heap allocations %llu (%.1f per generation)", allocations(), allocations() * perGeneration);
+    } else {
+        snprintf(line, sizeof(line), "  heap allocations not counted (build with -DPROFILE_ALLOCATIONS=1)");
+    }
+    cout << line << endl;
+}
+
+// Adds the time between its construction and its destruction to a phase, nothing if profiler is null
+class ScopedTimer
+{
+    private:
+#if PROFILING
+    Profiler* profiler;
+    ProfilePhase phase;
+    unsigned long long start;
+#endif
+
+    public:
+    ScopedTimer(Profiler* profiler, ProfilePhase phase); // Starts the timer.
+    ~ScopedTimer(); // Stops the timer.
+};
+
+// Time Complexity: O(1)
+// Space Complexity: O(1)
+ScopedTimer::ScopedTimer(Profiler* profiler, ProfilePhase phase)
+{
+#if PROFILING
+    this->profiler = profiler;
+    this->phase = phase;
+    this->start = profiler ? profileClock() : 0;
+#endif
+}
+
+// Time Complexity: O(1)
+// Space Complexity: O(1)
+ScopedTimer::~ScopedTimer()
+{
+#if PROFILING
+    if (profiler) {
+        profiler->addTime(phase, profileClock() - start);
+    }
+#endif
+}
+
+#endif
@@ -0,0 +1,236 @@
+#ifndef RANDOM_H
+#define RANDOM_H
+
+// Random number generation for the genetic algorithm
+// Every operator draws from its own stream instead of the global rand(), so operators can
+// run on any thread and a run can be replayed from its seed.
+// A stream is identified by (seed, phase, generation, index): the same key always gives the
+// same sequence, whatever thread happens to consume it.
+//
+// Constants and Macros:
+// - RNG_METHOD: Generator behind every stream (1 -> xoshiro256**, 2 -> PCG32).
+
+#include <cstdint>
+
+#ifndef RNG_METHOD
+#define RNG_METHOD 1 // 1 -> xoshiro256**, 2 -> PCG32
+#endif
+
+using namespace std;
+
+// SplitMix64 step, used to expand and mix seeds
+// Time Complexity: O(1)
+// Space Complexity: O(1)
+uint64_t splitMix64(uint64_t& state)
+{
+    uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+// xoshiro256** generator (Blackman & Vigna), 256 bits of state
+struct Xoshiro256
+{
+    uint64_t s[4];
+
+    // Fills the state from a 64-bit seed through SplitMix64, as recommended by the authors
+    // Time Complexity: O(1)
+    // Space Complexity: O(1)
+    void seed(uint64_t value)
+    {
+        for (int i = 0; i < 4; i++) {
+            s[i] = splitMix64(value);
+        }
+    }
+
+    // Time Complexity: O(1)
+    // Space Complexity: O(1)
+    uint64_t next()
+    {
+        uint64_t result = rotl(s[1] * 5, 7) * 9;
+        uint64_t t = s[1] << 17;
+        s[2] ^= s[0];
+        s[3] ^= s[1];
+        s[1] ^= s[2];
+        s[0] ^= s[3];
+        s[2] ^= t;
+        s[3] = rotl(s[3], 45);
+        return result;
+    }
+
+    static uint64_t rotl(uint64_t x, int k)
+    {
+        return (x << k) | (x >> (64 - k));
+    }
+};
+
+// PCG32 generator (O'Neill), XSH-RR output on a 64-bit LCG
+struct Pcg32
+{
+    uint64_t state;
+    uint64_t increment;
+
+    // Time Complexity: O(1)
+    // Space Complexity: O(1)
+    void seed(uint64_t value)
+    {
+        state = splitMix64(value);
+        increment = splitMix64(value) | 1; // The increment must be odd
+    }
+
+    // Time Complexity: O(1)
+    // Space Complexity: O(1)
+    uint32_t next32()
+    {
+        uint64_t old = state;
+        state = old * 6364136223846793005ULL + increment;
+        uint32_t xorshifted = (uint32_t)(((old >> 18) ^ old) >> 27);
+        uint32_t rot = (uint32_t)(old >> 59);
+        return (xorshifted >> rot) | (xorshifted << ((32 - rot) & 31));
+    }
+
+    // Time Complexity: O(1)
+    // Space Complexity: O(1)
+    uint64_t next()
+    {
+        uint64_t high = next32();
+        return (high << 32) | next32();
+    }
+};
+
+#if RNG_METHOD == 2
+typedef Pcg32 RngEngine;
+#else
+typedef Xoshiro256 RngEngine;
+#endif
+
+// A single random stream with the distributions used by the operators
+class Rng
+{
+    private:
+    RngEngine engine;
+
+    public:
+    Rng(uint64_t seed); // Constructor, seeds the engine.
+
+    // Methods
+    uint64_t next(); // Uniform 64-bit value.
+    double uniform(); // Uniform double in [0, 1).
+    uint32_t bounded(uint32_t bound); // Unbiased uniform integer in [0, bound), 0 if bound is 0.
+    bool coin(); // Fair coin flip.
+};
+
+// Constructor: seeds the engine of the stream
+// Time Complexity: O(1)
+// Space Complexity: O(1)
+Rng::Rng(uint64_t seed)
+{
+    engine.seed(seed);
+}
+
+// Time Complexity: O(1)
+// Space Complexity: O(1)
+uint64_t Rng::next()
+{
+    return engine.next();
+}
+
+// Uses the top 53 bits so every value is an exact multiple of 2^-53
+// Time Complexity: O(1)
+// Space Complexity: O(1)
+double Rng::uniform()
+{
+    return (engine.next() >> 11) * 0x1.0p-53;
+}
+
+// Lemire's multiply-and-reject method: no modulo bias and, most of the time, no division
+// Time Complexity: O(1) expected
+// Space Complexity: O(1)
+uint32_t Rng::bounded(uint32_t bound)
+{
+    if (bound == 0) {
+        return 0;
+    }
+    uint64_t product = (engine.next() >> 32) * (uint64_t)bound;
+    uint32_t low = (uint32_t)product;
+    if (low < bound) {
+        uint32_t threshold = (0u - bound) % bound;
+        while (low < threshold) {
+            product = (engine.next() >> 32) * (uint64_t)bound;
+            low = (uint32_t)product;
+        }
+    }
+    return (uint32_t)(product >> 32);
+}
+
+// Time Complexity: O(1)
+// Space Complexity: O(1)
+bool Rng::coin()
+{
+    return engine.next() >> 63;
+}
+
+// Phases of a generation, each one gets its own family of streams
+enum RandomPhase
+{
+    PHASE_INITIALIZATION = 1,
+    PHASE_SELECTION = 2,
+    PHASE_VARIATION = 3,
+    PHASE_LOCAL_SEARCH = 4,
+    PHASE_DECOMPOSITION = 5 // Cluster seeding of the decomposition (see Decomposition.h)
+};
+
+// Derives independent streams from one user seed
+class RandomStreams
+{
+    private:
+    uint64_t seed;
+
+    public:
+    RandomStreams(uint64_t seed); // Constructor with the user seed.
+
+    // Methods
+    uint64_t getSeed() const; // Returns the user seed.
+    Rng stream(uint64_t phase, uint64_t generation, uint64_t index) const; // Stream for one unit of work.
+    RandomStreams fork(uint64_t index) const; // Independent family of streams, e.g. for one island.
+};
+
+// Constructor
+// Time Complexity: O(1)
+// Space Complexity: O(1)
+RandomStreams::RandomStreams(uint64_t seed)
+{
+    this->seed = seed;
+}
+
+// Time Complexity: O(1)
+// Space Complexity: O(1)
+uint64_t RandomStreams::getSeed() const
+{
+    return seed;
+}
+
+// Hashes the key of a unit of work (e.g. one offspring pair of one generation) into a stream seed
+// Time Complexity: O(1)
+// Space Complexity: O(1)
+Rng RandomStreams::stream(uint64_t phase, uint64_t generation, uint64_t index) const
+{
+    uint64_t state = seed;
+    uint64_t key = splitMix64(state) ^ phase;
+    key = splitMix64(key) ^ generation;
+    key = splitMix64(key) ^ index;
+    return Rng(splitMix64(key));
+}
+
+// Derives a new family of streams that does not overlap with this one or with other forks
+// Time Complexity: O(1)
+// Space Complexity: O(1)
+RandomStreams RandomStreams::fork(uint64_t index) const
+{
+    uint64_t state = seed ^ 0xA0761D6478BD642FULL;
+    uint64_t key = splitMix64(state) ^ index;
+    return RandomStreams(splitMix64(key));
+}
+
+#endif
@@ -0,0 +1,197 @@
+// Command line client of the solver daemon (see SolverDaemon.h)
+// Sends an instance file to a running daemon, prints the progress frames and the result, and checks the
+// returned assignment against the capacities, bandwidths and connection constraint of the instance: a
+// result whose feasible flag disagrees with that check makes the client fail. --repeat sends the same
+// instance several times on one connection to measure the round trip of a warm daemon, the bandwidth
+// and capacity changes are sent afterwards as one delta, which the daemon re-solves from a warm start.
+//
+// Usage: SolverClient <socket> <instance.bin> [options]
+// - --seed N, --generations N, --population N, --time-budget S: solver settings, 0 -> daemon default
+// - --progress MS: ask for a progress frame at most every MS milliseconds (default: none)
+// - --repeat N: solve the instance N times
+// - --bandwidth CLIENT VALUE, --capacity SERVER VALUE: changes sent as a delta after the solves (repeatable)
+// - --shutdown: stop the daemon at the end
+
+#include "SolverDaemon.h"
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+#ifndef _WIN32
+
+// Client side of one connection
+struct DaemonClient
+{
+    int fd;
+    vector<unsigned char> receiveBuffer;
+    vector<unsigned char> sendBuffer;
+    vector<uint32_t> bandwidths; // Current bounds of the instance, deltas are applied to them
+    vector<uint32_t> capacities;
+};
+
+// Reads frames until the result of the current request, prints each of them
+// Time Complexity: O(F * S * C), F stands for the frames received
+// Space Complexity: O(S * C)
+bool receiveResult(DaemonClient& client)
+{
+    DaemonFrame frame;
+    while (readFrame(client.fd, frame, client.receiveBuffer)) {
+        if (frame.type == DAEMON_ERROR) {
+            cout << "Daemon error: " << string(client.receiveBuffer.begin(), client.receiveBuffer.end()) << endl;
+            return false;
+        }
+        DaemonSolution header;
+        if ((frame.type != DAEMON_PROGRESS && frame.type != DAEMON_RESULT) || client.receiveBuffer.size() < sizeof(header)) {
+            cout << "Unexpected frame of type " << frame.type << endl;
+            return false;
+        }
+        memcpy(&header, client.receiveBuffer.data(), sizeof(header));
+        if (client.receiveBuffer.size() != sizeof(header) + (size_t)header.numServers * header.numClients * sizeof(double)) {
+            cout << "Truncated solution frame" << endl;
+            return false;
+        }
+        const double* genes = (const double*)(client.receiveBuffer.data() + sizeof(header));
+        cout << (frame.type == DAEMON_PROGRESS ? "  progress" : "  result  ") << " generation " << header.generation
+             << " after " << header.seconds << " s: fitness " << header.fitness << ", latency score " << header.latencyScore
+             << (header.feasible ? ", feasible" : ", infeasible");
+        if (frame.type == DAEMON_RESULT) {
+            // The daemon's flag must match the client's own check, up to rounding at a bound
+            double worstExcess;
+            bool feasible = checkDaemonSolution(header, genes, client.bandwidths, client.capacities, worstExcess);
+            cout << (feasible ? ", client check: feasible" : ", client check: infeasible");
+            if (feasible != (header.feasible != 0) && fabs(worstExcess) > DAEMON_CHECK_TOLERANCE) {
+                cout << ", FEASIBILITY DISAGREES WITH THE DAEMON" << endl;
+                return false;
+            }
+            cout << endl;
+            return true;
+        }
+        cout << endl;
+    }
+    cout << "Connection closed by the daemon" << endl;
+    return false;
+}
+
+// Sends the instance as a DAEMON_SOLVE frame and waits for its result
+// Time Complexity: O(S * C) plus the solve
+// Space Complexity: O(S * C)
+bool sendSolve(DaemonClient& client, const MappedInstance& instance, const DaemonOptions& options, vector<unsigned char>& payload)
+{
+    const InstanceHeader& file = instance.header();
+    DaemonSolveHeader header = {(uint32_t)file.numServers, (uint32_t)file.numClients, options};
+    size_t latencyBytes = file.numServers * file.numClients * sizeof(double);
+    payload.resize(sizeof(header) + latencyBytes + (file.numServers + file.numClients) * sizeof(uint32_t));
+    unsigned char* next = payload.data();
+    memcpy(next, &header, sizeof(header));
+    memcpy(next += sizeof(header), instance.latencies(), latencyBytes);
+    memcpy(next += latencyBytes, client.bandwidths.data(), file.numClients * sizeof(uint32_t));
+    memcpy(next += file.numClients * sizeof(uint32_t), client.capacities.data(), file.numServers * sizeof(uint32_t));
+    return writeFrame(client.fd, DAEMON_SOLVE, payload.data(), payload.size(), nullptr, 0, client.sendBuffer) && receiveResult(client);
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 3) {
+        cout << "Usage: " << argv[0] << " <socket> <instance.bin> [--seed N] [--generations N] [--population N] [--time-budget S]" << endl;
+        cout << "       [--progress MS] [--repeat N] [--bandwidth CLIENT VALUE]... [--capacity SERVER VALUE]... [--shutdown]" << endl;
+        return 1;
+    }
+    DaemonOptions options;
+    memset(&options, 0, sizeof(options));
+    unsigned int repeat = 1;
+    bool shutdown = false;
+    vector<uint32_t> bandwidthChanges; // (client, value) pairs back to back
+    vector<uint32_t> capacityChanges;
+    for (int i = 3; i < argc; i++) {
+        string option = argv[i];
+        if (option == "--shutdown") {
+            shutdown = true;
+        } else if ((option == "--bandwidth" || option == "--capacity") && i + 2 < argc) {
+            vector<uint32_t>& changes = option == "--bandwidth" ? bandwidthChanges : capacityChanges;
+            changes.push_back(strtoul(argv[i + 1], nullptr, 10));
+            changes.push_back(strtoul(argv[i + 2], nullptr, 10));
+            i += 2;
+        } else if (i + 1 < argc) {
+            const char* text = argv[++i];
+            if (option == "--seed") {
+                options.seed = strtoull(text, nullptr, 10);
+            } else if (option == "--generations") {
+                options.generations = strtoul(text, nullptr, 10);
+            } else if (option == "--population") {
+                options.populationSize = strtoul(text, nullptr, 10);
+            } else if (option == "--time-budget") {
+                options.timeBudget = strtod(text, nullptr);
+            } else if (option == "--progress") {
+                options.progressMs = strtoul(text, nullptr, 10);
+            } else if (option == "--repeat") {
+                repeat = strtoul(text, nullptr, 10);
+            } else {
+                cout << "Unknown option " << option << endl;
+                return 1;
+            }
+        } else {
+            cout << "Missing value for option " << option << endl;
+            return 1;
+        }
+    }
+
+    MappedInstance instance;
+    if (!instance.open(argv[2])) {
+        return 1;
+    }
+    DaemonClient client;
+    client.fd = connectDaemon(argv[1]);
+    if (client.fd < 0) {
+        return 1;
+    }
+    client.bandwidths.assign(instance.bandwidths(), instance.bandwidths() + instance.header().numClients);
+    client.capacities.assign(instance.capacities(), instance.capacities() + instance.header().numServers);
+
+    typedef chrono::steady_clock Clock;
+    vector<unsigned char> payload;
+    bool ok = true;
+    for (unsigned int r = 0; r < repeat && ok; r++) {
+        Clock::time_point start = Clock::now();
+        ok = sendSolve(client, instance, options, payload);
+        cout << "Solve " << r + 1 << ": round trip " << chrono::duration<double, milli>(Clock::now() - start).count() << " ms" << endl;
+    }
+
+    if (ok && (bandwidthChanges.size() || capacityChanges.size())) {
+        DaemonDeltaHeader header = {(uint32_t)(bandwidthChanges.size() / 2), (uint32_t)(capacityChanges.size() / 2), options};
+        vector<uint32_t> pairs(bandwidthChanges);
+        pairs.insert(pairs.end(), capacityChanges.begin(), capacityChanges.end());
+        for (size_t c = 0; c + 1 < bandwidthChanges.size(); c += 2) {
+            if (bandwidthChanges[c] < client.bandwidths.size()) {
+                client.bandwidths[bandwidthChanges[c]] = bandwidthChanges[c + 1];
+            }
+        }
+        for (size_t c = 0; c + 1 < capacityChanges.size(); c += 2) {
+            if (capacityChanges[c] < client.capacities.size()) {
+                client.capacities[capacityChanges[c]] = capacityChanges[c + 1];
+            }
+        }
+        Clock::time_point start = Clock::now();
+        ok = writeFrame(client.fd, DAEMON_DELTA, &header, sizeof(header), pairs.data(), pairs.size() * sizeof(uint32_t), client.sendBuffer)
+             && receiveResult(client);
+        cout << "Delta: round trip " << chrono::duration<double, milli>(Clock::now() - start).count() << " ms" << endl;
+    }
+
+    if (shutdown) {
+        writeFrame(client.fd, DAEMON_SHUTDOWN, nullptr, 0, nullptr, 0, client.sendBuffer);
+    }
+    close(client.fd);
+    return ok ? 0 : 1;
+}
+
+#else
+
+int main()
+{
+    cout << "The solver daemon needs Unix domain sockets" << endl;
+    return 1;
+}
+
+#endif
@@ -0,0 +1,563 @@
+#ifndef SOLVERDAEMON_H
+#define SOLVERDAEMON_H
+
+// Long-lived solver service on a Unix domain socket
+// A client connects, sends an instance (or, later on the same connection, a delta of its bandwidths and
+// capacities) and receives the best solution so far while the solver runs, then the final solution.
+// The daemon keeps its thread pool and message buffers from one request to the next, and each
+// connection keeps the final population of its last solve, so a delta is re-solved from a warm start
+// (see rebalance()). Connections are served one after another, each solve uses the whole pool, so a
+// connection that sends nothing for DAEMON_IDLE_TIMEOUT seconds, or takes longer than DAEMON_FRAME_TIMEOUT
+// to deliver one frame, is dropped: a quiet or stalled client cannot hold the daemon.
+//
+// Protocol: every message is a frame, a DaemonFrame header followed by length bytes of payload. Numbers
+// are in host byte order (both ends run on the same machine), genes and latencies are float64.
+//   DAEMON_SOLVE     client -> daemon  DaemonSolveHeader, S * C latencies (row-major), C bandwidths, S capacities (uint32)
+//   DAEMON_DELTA     client -> daemon  DaemonDeltaHeader, (client, bandwidth) pairs, then (server, capacity) pairs (uint32)
+//   DAEMON_SHUTDOWN  client -> daemon  empty, the daemon stops after this connection
+//   DAEMON_PROGRESS  daemon -> client  DaemonSolution, S * C genes: best so far, at most one per progressMs
+//   DAEMON_RESULT    daemon -> client  DaemonSolution, S * C genes: end of a solve
+//   DAEMON_ERROR     daemon -> client  Message text, the request was not solved
+//
+// Constants and Macros:
+// - DAEMON_MAX_FRAME: Largest payload accepted, a longer frame is answered with DAEMON_ERROR and closes the connection.
+// - DAEMON_READ_CHUNK: Bytes a payload grows by while it is received, so memory follows what actually arrives.
+// - DAEMON_MAX_GENES: Largest population size * genes per individual a request may ask for.
+// - DAEMON_MAX_GENERATIONS: Largest number of generations a request may ask for.
+// - DAEMON_IDLE_TIMEOUT: Seconds a read or write on a client socket may block (SO_RCVTIMEO / SO_SNDTIMEO).
+// - DAEMON_FRAME_TIMEOUT: Seconds the payload of one frame may take to arrive once its header is read.
+// - DAEMON_BACKLOG: Pending connections the listening socket queues.
+// - DAEMON_CHECK_TOLERANCE: Relative distance to a bound within which checkDaemonSolution() may disagree with the solver.
+
+#include "GeneticAlgorithm.h"
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#ifndef _WIN32
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+#ifndef DAEMON_MAX_FRAME
+#define DAEMON_MAX_FRAME (256u << 20) // A 5000 x 5000 instance
+#endif
+#define DAEMON_READ_CHUNK (1u << 20)
+#ifndef DAEMON_MAX_GENES
+#define DAEMON_MAX_GENES (1ull << 27) // 1 GiB of double genes per generation buffer
+#endif
+#define DAEMON_MAX_GENERATIONS 1000000
+#define DAEMON_IDLE_TIMEOUT 60
+#define DAEMON_FRAME_TIMEOUT 60
+#define DAEMON_BACKLOG 16
+#define DAEMON_CHECK_TOLERANCE 1e-9
+
+using namespace std;
+
+// Message types
+enum DaemonMessage
+{
+    DAEMON_SOLVE = 1,
+    DAEMON_DELTA = 2,
+    DAEMON_SHUTDOWN = 3,
+    DAEMON_PROGRESS = 4,
+    DAEMON_RESULT = 5,
+    DAEMON_ERROR = 6
+};
+
+// Header of every frame
+struct DaemonFrame
+{
+    uint32_t type; // DaemonMessage
+    uint32_t length; // Payload bytes that follow
+};
+
+// Solver settings of a request, 0 -> the default of the daemon
+struct DaemonOptions
+{
+    uint64_t seed;
+    uint32_t generations;
+    uint32_t populationSize;
+    double timeBudget; // Seconds
+    uint32_t progressMs; // Milliseconds between two DAEMON_PROGRESS frames, 0 -> no progress frames
+    uint32_t reserved;
+};
+
+// Start of a DAEMON_SOLVE payload
+struct DaemonSolveHeader
+{
+    uint32_t numServers;
+    uint32_t numClients;
+    DaemonOptions options;
+};
+
+// Start of a DAEMON_DELTA payload
+struct DaemonDeltaHeader
+{
+    uint32_t numBandwidths; // (client, bandwidth) pairs that follow
+    uint32_t numCapacities; // (server, capacity) pairs after them
+    DaemonOptions options;
+};
+
+// Start of a DAEMON_PROGRESS or DAEMON_RESULT payload
+struct DaemonSolution
+{
+    uint32_t numServers;
+    uint32_t numClients;
+    double fitness;
+    double latencyScore;
+    uint32_t feasible; // 1 -> no constraint is violated
+    uint32_t generation; // Generation the solution was found in
+    double seconds; // Since the start of the solve
+};
+
+static_assert(sizeof(DaemonOptions) == 32 && sizeof(DaemonSolveHeader) == 40 && sizeof(DaemonDeltaHeader) == 40
+              && sizeof(DaemonSolution) == 40, "The protocol structs must not be padded");
+
+// Feasibility of a returned solution, recomputed from its genes and the bounds the client sent
+// Every gene must be positive (connection constraint), every server load within its capacity and every client
+// allocation within its bandwidth. worstExcess receives the largest load minus bound relative to the bound
+// (<= 0 when all bounds hold, INFINITY if a gene is 0), so a caller can tell a disagreement caused by
+// sums rounded across a bound (|worstExcess| <= DAEMON_CHECK_TOLERANCE) from a real one.
+// Time Complexity: O(S * C)
+// Space Complexity: O(S + C)
+bool checkDaemonSolution(const DaemonSolution& header, const double* genes, const vector<uint32_t>& bandwidths,
+                         const vector<uint32_t>& capacities, double& worstExcess)
+{
+    vector<double> serverSums(header.numServers, 0.0);
+    vector<double> clientSums(header.numClients, 0.0);
+    bool connected = true;
+    for (size_t i = 0; i < header.numServers; i++) {
+        for (size_t j = 0; j < header.numClients; j++) {
+            double gene;
+            memcpy(&gene, genes + i * header.numClients + j, sizeof(gene)); // Frame payloads are not aligned
+            serverSums[i] += gene;
+            clientSums[j] += gene;
+            connected = connected && gene > 0;
+        }
+    }
+    worstExcess = -INFINITY;
+    for (size_t i = 0; i < header.numServers; i++) {
+        worstExcess = max(worstExcess, (serverSums[i] - capacities[i]) / max(1.0, (double)capacities[i]));
+    }
+    for (size_t j = 0; j < header.numClients; j++) {
+        worstExcess = max(worstExcess, (clientSums[j] - bandwidths[j]) / max(1.0, (double)bandwidths[j]));
+    }
+    if (!connected) {
+        worstExcess = INFINITY;
+    }
+    return worstExcess <= 0;
+}
+
+#ifndef _WIN32
+
+// Writes all of data, retrying after partial writes
+// Time Complexity: O(N), N stands for the number of bytes
+// Space Complexity: O(1)
+bool writeFully(int fd, const void* data, size_t bytes)
+{
+    const char* next = (const char*)data;
+    while (bytes > 0) {
+        ssize_t written = write(fd, next, bytes);
+        if (written <= 0) {
+            return false;
+        }
+        next += written;
+        bytes -= written;
+    }
+    return true;
+}
+
+// Reads exactly bytes, false on end of stream, error (a receive timeout included) or once deadline has passed
+// Time Complexity: O(N)
+// Space Complexity: O(1)
+bool readFully(int fd, void* data, size_t bytes,
+               chrono::steady_clock::time_point deadline = chrono::steady_clock::time_point::max())
+{
+    char* next = (char*)data;
+    while (bytes > 0) {
+        ssize_t received = read(fd, next, bytes);
+        if (received <= 0 || chrono::steady_clock::now() > deadline) {
+            return false;
+        }
+        next += received;
+        bytes -= received;
+    }
+    return true;
+}
+
+// Reads one frame into payload (resized, its capacity is kept from one frame to the next)
+// False on end of stream, error, or a frame longer than DAEMON_MAX_FRAME (frame.length tells the caller).
+// The payload grows by DAEMON_READ_CHUNK as the bytes arrive, a header announcing a large frame that
+// never comes allocates no more than what was sent. The payload must arrive within DAEMON_FRAME_TIMEOUT.
+// Time Complexity: O(N)
+// Space Complexity: O(N) the first time a frame of that size is read
+bool readFrame(int fd, DaemonFrame& frame, vector<unsigned char>& payload)
+{
+    frame.length = 0;
+    if (!readFully(fd, &frame, sizeof(frame)) || frame.length > DAEMON_MAX_FRAME) {
+        return false;
+    }
+    chrono::steady_clock::time_point deadline = chrono::steady_clock::now() + chrono::seconds(DAEMON_FRAME_TIMEOUT);
+    payload.clear();
+    while (payload.size() < frame.length) {
+        size_t received = payload.size();
+        payload.resize(received + min<size_t>(frame.length - received, DAEMON_READ_CHUNK));
+        if (!readFully(fd, payload.data() + received, payload.size() - received, deadline)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Sends one frame made of a fixed header part and an optional array, in a single write
+// buffer: assembly space, reused from one frame to the next
+// Time Complexity: O(N)
+// Space Complexity: O(N) the first time a frame of that size is sent
+bool writeFrame(int fd, DaemonMessage type, const void* head, size_t headBytes, const void* tail, size_t tailBytes,
+                vector<unsigned char>& buffer)
+{
+    DaemonFrame frame = {(uint32_t)type, (uint32_t)(headBytes + tailBytes)};
+    buffer.resize(sizeof(frame) + headBytes + tailBytes);
+    memcpy(buffer.data(), &frame, sizeof(frame));
+    if (headBytes) {
+        memcpy(buffer.data() + sizeof(frame), head, headBytes);
+    }
+    if (tailBytes) {
+        memcpy(buffer.data() + sizeof(frame) + headBytes, tail, tailBytes);
+    }
+    return writeFully(fd, buffer.data(), buffer.size());
+}
+
+// Solver service, see the top of this file
+class SolverDaemon
+{
+    private:
+    GAConfig defaults; // Settings of every solve, DaemonOptions override some of them
+    ThreadPool pool; // Kept warm for every request
+    int listenFd;
+    string socketPath;
+    bool stopping; // Set by DAEMON_SHUTDOWN
+    vector<unsigned char> receiveBuffer; // Payload of the last frame read
+    vector<unsigned char> sendBuffer; // Assembly space of the frames sent
+    vector<double> geneBuffer; // Genes of a solution converted to float64
+
+    // Session of the current connection
+    Task task; // Instance of the last DAEMON_SOLVE
+    Population population; // Final population of the last solve, warm start of the next delta
+    bool hasTask;
+
+    void handleConnection(int fd); // Serves one client until it disconnects.
+    bool handleSolve(int fd); // Builds the task of a DAEMON_SOLVE payload and solves it.
+    bool handleDelta(int fd); // Applies a DAEMON_DELTA payload to the task and re-solves it warm.
+    bool solve(int fd, const DaemonOptions& options); // Solves task, streams progress and the result.
+    bool sendSolution(int fd, DaemonMessage type, const SolutionSnapshot& solution); // One DAEMON_PROGRESS or DAEMON_RESULT frame.
+    bool sendError(int fd, const string& message); // One DAEMON_ERROR frame.
+
+    public:
+    SolverDaemon(const GAConfig& defaults); // Constructor, starts the thread pool of defaults.numThreads.
+    ~SolverDaemon(); // Closes and removes the socket.
+
+    // Methods
+    bool listen(const string& path); // Binds the socket, a stale socket file at path is replaced.
+    void serve(); // Accepts connections one after the other until a DAEMON_SHUTDOWN.
+};
+
+// Constructor
+// Time Complexity: O(T) to start the workers
+// Space Complexity: O(T)
+SolverDaemon::SolverDaemon(const GAConfig& defaults)
+    : defaults(defaults), pool(defaults.numThreads)
+{
+    this->defaults.verbose = false; // The daemon is not the one reading the solver logs
+    this->defaults.printBest = false;
+    this->listenFd = -1;
+    this->stopping = false;
+    this->hasTask = false;
+}
+
+// Destructor
+// Time Complexity: O(1)
+// Space Complexity: O(1)
+SolverDaemon::~SolverDaemon()
+{
+    if (listenFd >= 0) {
+        close(listenFd);
+        unlink(socketPath.c_str());
+    }
+}
+
+// Time Complexity: O(1)
+// Space Complexity: O(1)
+bool SolverDaemon::listen(const string& path)
+{
+    sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(address.sun_path)) {
+        cout << "Socket path " << path << " is too long" << endl;
+        return false;
+    }
+    memcpy(address.sun_path, path.c_str(), path.size());
+    unlink(path.c_str()); // Left behind by a daemon that did not shut down cleanly
+
+    listenFd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listenFd < 0 || ::bind(listenFd, (sockaddr*)&address, sizeof(address)) != 0 || ::listen(listenFd, DAEMON_BACKLOG) != 0) {
+        cout << "Cannot listen on " << path << ": " << strerror(errno) << endl;
+        if (listenFd >= 0) {
+            close(listenFd);
+            listenFd = -1;
+        }
+        return false;
+    }
+    socketPath = path;
+    return true;
+}
+
+// A client that disconnects while a frame is sent must not kill the daemon: SIGPIPE is ignored
+// Every read and write of a connection blocks at most DAEMON_IDLE_TIMEOUT seconds, then fails like a
+// disconnection would, which drops the connection.
+// Time Complexity: O(R * solve), R stands for the requests served
+// Space Complexity: O(P * S * C) of the largest request
+void SolverDaemon::serve()
+{
+    signal(SIGPIPE, SIG_IGN);
+    timeval timeout;
+    timeout.tv_sec = DAEMON_IDLE_TIMEOUT;
+    timeout.tv_usec = 0;
+    while (!stopping) {
+        int fd = accept(listenFd, nullptr, nullptr);
+        if (fd < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            cout << "accept failed: " << strerror(errno) << endl;
+            return;
+        }
+        if (setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout)) != 0
+            || setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout)) != 0) {
+            cout << "Cannot set the timeouts of a connection: " << strerror(errno) << endl;
+            close(fd);
+            continue;
+        }
+        handleConnection(fd);
+        close(fd);
+    }
+}
+
+// A request that throws (e.g. bad_alloc) is answered with DAEMON_ERROR and drops the session, the
+// daemon keeps serving. The rest of an oversized frame is never read, so it ends the connection.
+// Time Complexity: O(R * solve)
+// Space Complexity: O(P * S * C)
+void SolverDaemon::handleConnection(int fd)
+{
+    hasTask = false;
+    population = Population(); // No warm start from another client
+    DaemonFrame frame;
+    while (readFrame(fd, frame, receiveBuffer)) {
+        bool ok;
+        try {
+            if (frame.type == DAEMON_SOLVE) {
+                ok = handleSolve(fd);
+            } else if (frame.type == DAEMON_DELTA) {
+                ok = handleDelta(fd);
+            } else if (frame.type == DAEMON_SHUTDOWN) {
+                stopping = true;
+                return;
+            } else {
+                ok = sendError(fd, "Unknown message type " + to_string(frame.type));
+            }
+        } catch (const exception& error) {
+            hasTask = false;
+            population = Population();
+            ok = sendError(fd, string("Request failed: ") + error.what());
+        }
+        if (!ok) {
+            return; // The client is gone
+        }
+    }
+    if (frame.length > DAEMON_MAX_FRAME) {
+        sendError(fd, "Frame of " + to_string(frame.length) + " bytes, the limit is " + to_string(DAEMON_MAX_FRAME));
+    }
+}
+
+// The payload is checked in full before the task is touched
+// Time Complexity: O(S * C) plus the solve
+// Space Complexity: O(S * C)
+bool SolverDaemon::handleSolve(int fd)
+{
+    DaemonSolveHeader header;
+    if (receiveBuffer.size() < sizeof(header)) {
+        return sendError(fd, "Truncated solve request");
+    }
+    memcpy(&header, receiveBuffer.data(), sizeof(header));
+    size_t numServers = header.numServers, numClients = header.numClients;
+    if (numServers == 0 || numClients == 0
+        || receiveBuffer.size() != sizeof(header) + numServers * numClients * sizeof(double) + (numServers + numClients) * sizeof(uint32_t)) {
+        return sendError(fd, "Solve request size does not match " + to_string(numServers) + " x " + to_string(numClients));
+    }
+    const unsigned char* latencies = receiveBuffer.data() + sizeof(header);
+    const unsigned char* bandwidths = latencies + numServers * numClients * sizeof(double);
+    const unsigned char* capacities = bandwidths + numClients * sizeof(uint32_t);
+    for (size_t k = 0; k < numServers * numClients; k++) {
+        double latency;
+        memcpy(&latency, latencies + k * sizeof(double), sizeof(double)); // The payload is not aligned for doubles
+        if (!(latency > 0) || std::isinf(latency)) {
+            return sendError(fd, "Latencies must be positive and finite");
+        }
+    }
+
+    task = Task(numServers, numClients);
+    for (size_t i = 0; i < numServers; i++) {
+        for (size_t j = 0; j < numClients; j++) {
+            double latency;
+            memcpy(&latency, latencies + (i * numClients + j) * sizeof(double), sizeof(double));
+            task.setLatency(i, j, latency);
+        }
+        uint32_t capacity;
+        memcpy(&capacity, capacities + i * sizeof(uint32_t), sizeof(uint32_t));
+        task.setCapacity(i, capacity);
+    }
+    for (size_t j = 0; j < numClients; j++) {
+        uint32_t bandwidth;
+        memcpy(&bandwidth, bandwidths + j * sizeof(uint32_t), sizeof(uint32_t));
+        task.setBandwith(j, bandwidth);
+    }
+    hasTask = true;
+    population = Population(); // Cold start
+    return solve(fd, header.options);
+}
+
+// Time Complexity: O(D) plus the solve, D stands for the number of changes
+// Space Complexity: O(D)
+bool SolverDaemon::handleDelta(int fd)
+{
+    DaemonDeltaHeader header;
+    if (receiveBuffer.size() < sizeof(header)) {
+        return sendError(fd, "Truncated delta request");
+    }
+    memcpy(&header, receiveBuffer.data(), sizeof(header));
+    size_t changes = (size_t)header.numBandwidths + header.numCapacities;
+    if (receiveBuffer.size() != sizeof(header) + changes * 2 * sizeof(uint32_t)) {
+        return sendError(fd, "Delta request size does not match its counts");
+    }
+    if (!hasTask) {
+        return sendError(fd, "Delta without a previous solve on this connection");
+    }
+    TaskDelta delta;
+    const unsigned char* next = receiveBuffer.data() + sizeof(header);
+    for (size_t c = 0; c < changes; c++) {
+        uint32_t pair[2];
+        memcpy(pair, next + c * sizeof(pair), sizeof(pair));
+        if (c < header.numBandwidths) {
+            delta.bandwidths.push_back(make_pair(pair[0], pair[1]));
+        } else {
+            delta.capacities.push_back(make_pair(pair[0], pair[1]));
+        }
+    }
+    if (!task.applyDelta(delta)) {
+        return sendError(fd, "Delta names a server or client the task does not have");
+    }
+    return solve(fd, header.options); // population holds the previous final population: warm start
+}
+
+// Progress frames are sent from the improvement callback, which runs on this thread between two
+// generations. A failed send only stops the progress frames, the result is still attempted.
+// Time Complexity: O(G * P * S * C / T)
+// Space Complexity: O(P * S * C)
+bool SolverDaemon::solve(int fd, const DaemonOptions& options)
+{
+    typedef chrono::steady_clock Clock;
+    GAConfig config = defaults;
+    if (options.seed) {
+        config.seed = options.seed;
+    }
+    if (options.generations) {
+        config.generations = options.generations;
+    }
+    if (options.populationSize) {
+        config.populationSize = options.populationSize;
+    }
+    if (options.timeBudget > 0) {
+        config.timeBudget = options.timeBudget;
+    }
+    if ((unsigned long long)config.populationSize * task.getNumGenes() > DAEMON_MAX_GENES) {
+        return sendError(fd, "Population " + to_string(config.populationSize) + " x " + to_string(task.getNumGenes())
+                             + " genes exceeds the limit of " + to_string(DAEMON_MAX_GENES) + " genes");
+    }
+    if (config.generations > DAEMON_MAX_GENERATIONS) {
+        return sendError(fd, to_string(config.generations) + " generations exceed the limit of " + to_string(DAEMON_MAX_GENERATIONS));
+    }
+    BestSolution best;
+    config.bestSolution = &best;
+    config.population = &population;
+    bool connected = true;
+    Clock::time_point lastProgress = Clock::now();
+    if (options.progressMs) {
+        config.onImprovement = [&](const BestSolution& solution) {
+            Clock::time_point now = Clock::now();
+            if (connected && now - lastProgress >= chrono::milliseconds(options.progressMs)) {
+                lastProgress = now;
+                connected = sendSolution(fd, DAEMON_PROGRESS, solution.snapshot());
+            }
+        };
+    }
+    geneticAlgorithm(task, config, pool);
+    return sendSolution(fd, DAEMON_RESULT, best.snapshot());
+}
+
+// Time Complexity: O(S * C)
+// Space Complexity: O(S * C) the first time a solution of that size is sent
+bool SolverDaemon::sendSolution(int fd, DaemonMessage type, const SolutionSnapshot& solution)
+{
+    DaemonSolution header;
+    header.numServers = task.getNumServers();
+    header.numClients = task.getNumClients();
+    header.fitness = solution.fitness;
+    header.latencyScore = solution.latencyScore;
+    header.feasible = solution.isFeas;
+    header.generation = solution.generation;
+    header.seconds = solution.seconds;
+    geneBuffer.assign(solution.genes.begin(), solution.genes.end());
+    return writeFrame(fd, type, &header, sizeof(header), geneBuffer.data(), geneBuffer.size() * sizeof(double), sendBuffer);
+}
+
+// Time Complexity: O(L), L stands for the length of the message
+// Space Complexity: O(L)
+bool SolverDaemon::sendError(int fd, const string& message)
+{
+    return writeFrame(fd, DAEMON_ERROR, message.data(), message.size(), nullptr, 0, sendBuffer);
+}
+
+// Connects to a daemon, -1 (with a message) if nothing listens at path
+// Time Complexity: O(1)
+// Space Complexity: O(1)
+int connectDaemon(const string& path)
+{
+    sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(address.sun_path)) {
+        cout << "Socket path " << path << " is too long" << endl;
+        return -1;
+    }
+    memcpy(address.sun_path, path.c_str(), path.size());
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0 || connect(fd, (sockaddr*)&address, sizeof(address)) != 0) {
+        cout << "Cannot connect to " << path << ": " << strerror(errno) << endl;
+        if (fd >= 0) {
+            close(fd);
+        }
+        return -1;
+    }
+    return fd;
+}
+
+#endif
+
+#endif
@@ -1,24 +1,57 @@
+#ifndef TASK_H
+#define TASK_H
+
 #include <iostream>
 #include <string>
 #include <cmath>
 #include <ctime>
 #include <cstdlib>
 #include <vector>
+#include <limits>
+#include <algorithm>
+#include <memory>
+#include "InstanceFile.h"
 
 using namespace std;
 
+// Changes of the bandwidths and capacities of a task between two solves (see rebalance())
+struct TaskDelta
+{
+    vector<pair<unsigned int, unsigned int>> bandwidths; // (client, new bandwidth)
+    vector<pair<unsigned int, unsigned int>> capacities; // (server, new capacity)
+};
+
 class Task
 {
     private:
-    vector<vector<double>> latencyMatrix;  // Matrix to store latency between servers and clients.
+    vector<double> latencyMatrix;  // Row-major S x C latencies (one per edge if sparse), empty while they are read from mappedFile.
+    shared_ptr<MappedInstance> mappedFile; // Instance file the latencies are mapped from, shared by copies.
     vector<unsigned int> bandwithClients; // Bandwidth requirement for each client.
     vector<unsigned int> capacityServers; // Capacity of each server.
     unsigned int numServers;  // Number of servers.
     unsigned int numClients;  // Number of clients.
 
+    // Sparse mode: only the reachable server-client pairs (edges) exist, stored as CSR rows.
+    // The edges of server i are [edgeStart[i], edgeStart[i + 1]), edgeClients holds their clients
+    // in increasing order. Dense tasks get edgeStart[i] = i * C from freeze() and no edgeClients.
+    bool sparse;
+    vector<unsigned int> edgeStart;
+    vector<unsigned int> edgeClients;
+
+    // Problem-invariant tables built by freeze(), one entry per gene like the chromosomes
+    vector<double> inverseLatency; // 1 / latency of each server-client pair.
+    vector<double> latencyTotals; // Sum of the inverse latencies of each client over all (reachable) servers.
+    vector<double> idealAllocations; // Latency-proportional share of each client's bandwidth per server.
+    bool frozen; // True while the tables match the current attributes.
+
+    const double* latencies(); // Latencies in gene order, owned or mapped.
+    double* writableLatencies(); // Owned latencies, copies a mapped matrix first.
+    long long edgeIndex(int server, int client); // Gene of a pair, -1 if invalid or unreachable.
+
     public:
     Task(int NumServers, int numClients); // Constructor with number of servers and clients.
     Task(int NumServers, int numClients, vector<vector<double>>); // Constructor with a predefined latency matrix.
+    Task(int NumServers, int numClients, vector<unsigned int> edgeStart, vector<unsigned int> edgeClients, vector<double> edgeLatencies); // Sparse task from CSR reachability lists.
     Task(); // Default constructor.
 
     // Methods
@@ -33,8 +66,20 @@ class Task
     void setBandwith(int client, unsigned int bw); // Sets the bandwidth for a specific client.
     unsigned int getCapacity(int server); // Gets the capacity of a specific server.
     void setCapacity(int server, unsigned int cap); // Sets the capacity for a specific server.
+    bool applyDelta(const TaskDelta& delta); // Sets every bandwidth and capacity of a delta, nothing if an index is invalid.
     void inputMatrix(); // Inputs the latency matrix from the user.
     void printMatrix(); // Prints the latency matrix.
+    bool loadInstance(const string& path); // Maps a binary instance file (see InstanceFile.h).
+    bool saveInstance(const string& path); // Writes the task as a binary instance file.
+    void freeze(); // Builds the solver tables, call again after any setter.
+    bool isFrozen(); // Returns true if the solver tables are up to date.
+    const double* getInverseLatencyTable(); // Inverse latencies in gene order.
+    const double* getLatencyTotals(); // Per-client inverse latency totals.
+    const double* getIdealAllocations(); // Ideal allocations in gene order.
+    bool isSparse(); // Returns true if only reachable pairs are stored.
+    unsigned int getNumGenes() const; // Genes per chromosome: S * C, or the number of edges if sparse.
+    const unsigned int* getEdgeStart(); // First gene of each server, S + 1 values (valid after freeze()).
+    const unsigned int* getEdgeClients(); // Client of each gene, null for dense tasks.
 };
 
 // Default constructor: Initializes numServers and numClients to 0
@@ -45,6 +90,8 @@ Task::Task()
 {
     this->numServers = 0;    // Default number of servers is set to 0
     this->numClients = 0;    // Default number of clients is set to 0
+    this->sparse = false;    // Dense until reachability lists are given
+    this->frozen = false;    // No solver tables yet
     
 }
 
@@ -61,8 +108,8 @@ Task::Task(int numServers, int numClients)
     this->numServers = numServers; // Set the number of servers for the task
     this->numClients = numClients; // Set the number of clients for the task
 
-    // Create a 2D latency matrix with all elements initialized to 0.0
-    this->latencyMatrix = vector<vector<double>>(numServers, vector<double>(numClients, 0));
+    // Create a row-major latency matrix with all elements initialized to 0.0
+    this->latencyMatrix = vector<double>((size_t)numServers * numClients, 0);
 
     // Create a vector to store bandwidth for each client (initialized to default value of 0)
     this->bandwithClients = vector<unsigned int>(this->numClients);
@@ -70,23 +117,33 @@ Task::Task(int numServers, int numClients)
     // Create a vector to store capacity for each server (initialized to default value of 0)
     this->capacityServers = vector<unsigned int>(this->numServers);
 
+    this->sparse = false; // Every server-client pair exists
+    this->frozen = false; // Solver tables are built by freeze()
+
     
 }
 
 // Constructor: Initializes Task with specified number of servers, clients, and an existing latency matrix
-// Time Complexity: O(1) (no new memory allocation for latencyMatrix, as it's passed in)
-// Space Complexity: O(S + C), where:
+// Time Complexity: O(S * C), the matrix is flattened into a row-major buffer
+// Space Complexity: O(S * C + S + C), where:
+//  - O(S * C) for latencyMatrix
 //  - O(S) for capacityServers
 //  - O(C) for bandwithClients
-//  - Latency matrix is passed by reference, so no new space is allocated.
 
 Task::Task(int numServers, int numClients, vector<vector<double>> matrix)
 {
     this->numServers = numServers; // Set the number of servers for the task
     this->numClients = numClients; // Set the number of clients for the task
 
-    // Set the latency matrix to the provided matrix
-    this->latencyMatrix = matrix;
+    // Copy the first numServers rows of the provided matrix, row-major
+    this->latencyMatrix = vector<double>((size_t)numServers * numClients);
+    for (int i = 0; i < numServers; i++)
+    {
+        for (int j = 0; j < numClients; j++)
+        {
+            this->latencyMatrix[(size_t)i * numClients + j] = matrix[i][j];
+        }
+    }
 
     // Create a vector to store bandwidth for each client (initialized to default value of 0)
     this->bandwithClients = vector<unsigned int>(this->numClients);
@@ -94,9 +151,48 @@ Task::Task(int numServers, int numClients, vector<vector<double>> matrix)
     // Create a vector to store capacity for each server (initialized to default value of 0)
     this->capacityServers = vector<unsigned int>(this->numServers);
 
+    this->sparse = false; // Every server-client pair exists
+    this->frozen = false; // Solver tables are built by freeze()
+
     
 }
 
+// Constructor: sparse task, only the listed server-client pairs are reachable
+// edgeStart has S + 1 offsets into edgeClients / edgeLatencies, the clients of a server must be increasing.
+// Invalid lists are reported and leave an empty task.
+// Time Complexity: O(S + E), E stands for the number of reachable pairs
+// Space Complexity: O(S + C + E), nothing is S * C
+Task::Task(int numServers, int numClients, vector<unsigned int> edgeStart, vector<unsigned int> edgeClients, vector<double> edgeLatencies)
+{
+    this->numServers = numServers;
+    this->numClients = numClients;
+    this->sparse = true;
+    this->frozen = false;
+
+    bool valid = numServers > 0 && numClients > 0 && edgeStart.size() == (size_t)numServers + 1 && edgeStart[0] == 0
+                 && edgeStart[numServers] == edgeClients.size() && edgeClients.size() == edgeLatencies.size();
+    for (int i = 0; valid && i < numServers; i++)
+    {
+        valid = edgeStart[i] <= edgeStart[i + 1];
+        for (unsigned int k = edgeStart[i]; valid && k < edgeStart[i + 1]; k++)
+        {
+            valid = edgeClients[k] < (unsigned int)numClients && (k == edgeStart[i] || edgeClients[k - 1] < edgeClients[k]);
+        }
+    }
+    if (!valid)
+    {
+        cout << "Invalid sparse latency lists." << endl;
+        clear();
+        return;
+    }
+
+    this->edgeStart = edgeStart;
+    this->edgeClients = edgeClients;
+    this->latencyMatrix = edgeLatencies;
+    this->bandwithClients = vector<unsigned int>(this->numClients);
+    this->capacityServers = vector<unsigned int>(this->numServers);
+}
+
 // Method to input latency values between clients and servers
 // Time Complexity: O(S * C), where S is the number of servers and C is the number of clients
 // (inputting latency values for all client-server pairs)
@@ -105,21 +201,26 @@ Task::Task(int numServers, int numClients, vector<vector<double>> matrix)
 void Task::inputMatrix()
 {
     cout << "Enter the latency values between clients and servers:" << endl;
+    frozen = false; // The solver tables no longer match the latencies
+    double* matrix = writableLatencies();
 
-    // Loop over all servers and clients to input their latency values
+    // Loop over all servers and (reachable) clients to input their latency values
     for (unsigned int i = 0; i < numServers; i++) 
     {
-        for (unsigned int j = 0; j < numClients; j++) 
+        unsigned int first = sparse ? edgeStart[i] : i * numClients;
+        unsigned int last = sparse ? edgeStart[i + 1] : (i + 1) * numClients;
+        for (unsigned int k = first; k < last; k++) 
         {
             // Get the latency value for the specific client-server pair
-            cin >> latencyMatrix[i][j];
+            double& latency = matrix[k];
+            cin >> latency;
 
             // Input validation loop to ensure the user enters a valid floating-point number
             while (std::cin.fail()) {
                 std::cin.clear();  // Clear the error flag
                 std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n'); // Ignore invalid input
                 std::cout << "Invalid input. Please enter a valid floating-point number.\n"; // Prompt user for input again
-                cin >> latencyMatrix[i][j]; // Re-enter latency value
+                cin >> latency; // Re-enter latency value
             }
         }
     }
@@ -135,13 +236,19 @@ void Task::inputMatrix()
 void Task::printMatrix()
 {
     cout << "The latency matrix is:" << endl;
+    const double* matrix = latencies();
     
     // Loop through all servers and clients to print the latency matrix
     for (unsigned int i = 0; i < numServers; i++) 
     {
         for (unsigned int j = 0; j < numClients; j++) 
         {
-            cout << latencyMatrix[i][j] << " ";  // Print the latency value for each client-server pair
+            long long k = edgeIndex(i, j);
+            if (k < 0) {
+                cout << "- ";  // Unreachable pair of a sparse task
+            } else {
+                cout << matrix[k] << " ";  // Print the latency value for each client-server pair
+            }
         }
         cout << endl;  // Print a newline after each row (server)
     }
@@ -178,9 +285,10 @@ unsigned int Task::getNumClients()
 // Space Complexity: O(1) (no additional space required)
 void Task::setNumServers(int num)
 {
-    if(num > 0)  // Validate if the number of servers is greater than 0
+    if(num > 0 && !sparse)  // Validate if the number of servers is greater than 0, sparse lists have a fixed shape
     {
         this->numServers = num;  // Set the number of servers
+        this->frozen = false;
     }
     else
     {
@@ -196,9 +304,10 @@ void Task::setNumServers(int num)
 
 void Task::setNumClients(int num)
 {
-    if(num > 0)  // Validate if the number of clients is greater than 0
+    if(num > 0 && !sparse)  // Validate if the number of clients is greater than 0, sparse lists have a fixed shape
     {
         this->numClients = num;  // Set the number of clients
+        this->frozen = false;
     }
     else
     {
@@ -217,20 +326,30 @@ void Task::clear()
     numServers = 0;    // Reset the number of servers to 0
     numClients = 0;    // Reset the number of clients to 0
     latencyMatrix.clear();  // Clear the latency matrix (removes all elements)
+    mappedFile.reset();  // Unmaps the instance file once no copy uses it
+    sparse = false;  // Back to an empty dense task
+    edgeStart.clear();
+    edgeClients.clear();
+    frozen = false;  // Drop the solver tables as well
+    inverseLatency.clear();
+    latencyTotals.clear();
+    idealAllocations.clear();
 
     
 }
 
 
 // Method to set the latency between a specific server and client
-// Time Complexity: O(1) 
+// Time Complexity: O(1), O(log E) for a sparse task
 // Space Complexity: O(1) (no additional space is allocated)
 void Task::setLatency(int server, int client, double value)
 {
-    // Check if the server, client, and value are valid
-    if (client >= 0 && client < numClients && server >= 0 && server < numServers && value >= 0)
+    // Check if the server, client, and value are valid (and the pair reachable in a sparse task)
+    long long k = edgeIndex(server, client);
+    if (k >= 0 && value >= 0)
     {
-        latencyMatrix[server][client] = value;  // Set the latency value for the specified server-client pair
+        writableLatencies()[k] = value;  // Set the latency value for the specified server-client pair
+        frozen = false;
     }
     else
     {
@@ -241,15 +360,16 @@ void Task::setLatency(int server, int client, double value)
 }
 
 // Method to get the latency between a specific server and client
-// Time Complexity: O(1) 
+// Time Complexity: O(1), O(log E) for a sparse task
 // Space Complexity: O(1) (no additional space required)
 double Task::getLatency(int server, int client)
 {
     // Check if the server and client are valid
-    if(server < 0 || client < 0 || client >= this->numClients || server >= this->numServers){
-        return -1;  // Return -1 for invalid server or client index
+    long long k = edgeIndex(server, client);
+    if(k < 0){
+        return -1;  // Return -1 for invalid server or client index, or an unreachable pair
     }
-    return latencyMatrix[server][client];  // Return the latency value for the specified server-client pair
+    return latencies()[k];  // Return the latency value for the specified server-client pair
 
     
 }
@@ -290,6 +410,7 @@ void Task::setBandwith(int client, unsigned int bw)
     // Check if the client index is valid
     if(client >= 0 && client < this->numClients){
         this->bandwithClients[client] = bw;  // Set the bandwidth value for the specified client
+        this->frozen = false;
     }
 
     
@@ -301,9 +422,252 @@ void Task::setBandwith(int client, unsigned int bw)
 void Task::setCapacity(int server, unsigned int cap)
 {
     // Check if the server index is valid
-    if(server >= 0 && server < this->numClients){  // Note: The check should be against `numServers`, not `numClients`
+    if(server >= 0 && server < this->numServers){
         this->capacityServers[server] = cap;  // Set the capacity value for the specified server
+        this->frozen = false;
     }
 
    
 }
+
+// Method to apply the bandwidth and capacity changes of a delta
+// Every index is checked before anything changes, so an invalid delta leaves the task as it was
+// Time Complexity: O(D), D stands for the number of changes
+// Space Complexity: O(1)
+bool Task::applyDelta(const TaskDelta& delta)
+{
+    for (const pair<unsigned int, unsigned int>& change : delta.bandwidths) {
+        if (change.first >= this->numClients) {
+            cout << "Delta names client " << change.first << " of a task with " << this->numClients << " clients" << endl;
+            return false;
+        }
+    }
+    for (const pair<unsigned int, unsigned int>& change : delta.capacities) {
+        if (change.first >= this->numServers) {
+            cout << "Delta names server " << change.first << " of a task with " << this->numServers << " servers" << endl;
+            return false;
+        }
+    }
+
+    for (const pair<unsigned int, unsigned int>& change : delta.bandwidths) {
+        this->bandwithClients[change.first] = change.second;
+    }
+    for (const pair<unsigned int, unsigned int>& change : delta.capacities) {
+        this->capacityServers[change.first] = change.second; // Checked against numServers above
+    }
+    this->frozen = false;
+    return true;
+}
+
+// Method to build the problem-invariant tables used by the solver
+// Everything the fitness function needs per server-client pair is computed once here,
+// so evaluating an individual is a single pass over its allocations without divisions.
+// Time Complexity: O(S * C), where S is the number of servers and C is the number of clients (O(S + C + E) if sparse)
+// Space Complexity: O(S * C) for the inverse latency and ideal allocation tables (O(E) if sparse), O(C) for the totals
+void Task::freeze()
+{
+    if (!sparse)
+    {
+        // A dense task is the CSR list of every pair, row i starts at gene i * C
+        edgeStart = vector<unsigned int>(numServers + 1);
+        for (unsigned int i = 0; i <= numServers; i++) 
+        {
+            edgeStart[i] = i * numClients;
+        }
+    }
+    size_t numGenes = getNumGenes();
+    inverseLatency = vector<double>(numGenes);
+    latencyTotals = vector<double>(numClients, 0.0);
+    idealAllocations = vector<double>(numGenes);
+    const double* matrix = latencies();
+
+    // Inverse latency of every pair and the per-client totals
+    for (unsigned int i = 0; i < numServers; i++) 
+    {
+        for (unsigned int k = edgeStart[i]; k < edgeStart[i + 1]; k++) 
+        {
+            unsigned int j = sparse ? edgeClients[k] : k - edgeStart[i];
+            double inverse = 1.0 / matrix[k];
+            inverseLatency[k] = inverse;
+            latencyTotals[j] += inverse;
+        }
+    }
+
+    // Ideal allocation: each client's bandwidth split in proportion to the inverse latencies
+    for (unsigned int i = 0; i < numServers; i++) 
+    {
+        for (unsigned int k = edgeStart[i]; k < edgeStart[i + 1]; k++) 
+        {
+            unsigned int j = sparse ? edgeClients[k] : k - edgeStart[i];
+            idealAllocations[k] = bandwithClients[j] * inverseLatency[k] / latencyTotals[j];
+        }
+    }
+
+    frozen = true;
+}
+
+// Returns true if the solver tables match the current attributes
+// Time Complexity: O(1)
+// Space Complexity: O(1)
+bool Task::isFrozen()
+{
+    return frozen;
+}
+
+// Getter for the inverse latency table (valid after freeze())
+// Time Complexity: O(1)
+// Space Complexity: O(1)
+const double* Task::getInverseLatencyTable()
+{
+    return inverseLatency.data();
+}
+
+// Getter for the per-client inverse latency totals (valid after freeze())
+// Time Complexity: O(1)
+// Space Complexity: O(1)
+const double* Task::getLatencyTotals()
+{
+    return latencyTotals.data();
+}
+
+// Getter for the ideal allocation table (valid after freeze())
+// Time Complexity: O(1)
+// Space Complexity: O(1)
+const double* Task::getIdealAllocations()
+{
+    return idealAllocations.data();
+}
+
+// Row-major latencies: the mapped file if the task was loaded from one, the owned matrix otherwise
+// Time Complexity: O(1)
+// Space Complexity: O(1)
+const double* Task::latencies()
+{
+    return mappedFile ? mappedFile->latencies() : latencyMatrix.data();
+}
+
+// Latencies that may be modified. A mapped matrix is read-only and shared with the copies of
+// the task, so it is copied into the owned matrix on the first write.
+// Time Complexity: O(1), O(S * C) on the first write to a mapped task
+// Space Complexity: O(1), O(S * C) on the first write to a mapped task
+double* Task::writableLatencies()
+{
+    if (mappedFile) {
+        const double* mapped = mappedFile->latencies();
+        latencyMatrix.assign(mapped, mapped + (size_t)numServers * numClients);
+        mappedFile.reset();
+    }
+    return latencyMatrix.data();
+}
+
+// Gene index of a server-client pair: row-major in a dense task, binary search in the server's edges if sparse
+// Time Complexity: O(1), O(log E) for a sparse task
+// Space Complexity: O(1)
+long long Task::edgeIndex(int server, int client)
+{
+    if (server < 0 || client < 0 || client >= (int)numClients || server >= (int)numServers) {
+        return -1;
+    }
+    if (!sparse) {
+        return (long long)server * numClients + client;
+    }
+    vector<unsigned int>::iterator first = edgeClients.begin() + edgeStart[server];
+    vector<unsigned int>::iterator last = edgeClients.begin() + edgeStart[server + 1];
+    vector<unsigned int>::iterator found = lower_bound(first, last, (unsigned int)client);
+    if (found == last || *found != (unsigned int)client) {
+        return -1;
+    }
+    return found - edgeClients.begin();
+}
+
+// Time Complexity: O(1)
+// Space Complexity: O(1)
+bool Task::isSparse()
+{
+    return sparse;
+}
+
+// Time Complexity: O(1)
+// Space Complexity: O(1)
+unsigned int Task::getNumGenes() const
+{
+    return sparse ? edgeClients.size() : numServers * numClients;
+}
+
+// Getter for the CSR row offsets, dense tasks get theirs from freeze()
+// Time Complexity: O(1)
+// Space Complexity: O(1)
+const unsigned int* Task::getEdgeStart()
+{
+    return edgeStart.data();
+}
+
+// Getter for the client of each gene, null for a dense task where it follows from the row offset
+// Time Complexity: O(1)
+// Space Complexity: O(1)
+const unsigned int* Task::getEdgeClients()
+{
+    return sparse ? edgeClients.data() : nullptr;
+}
+
+// Loads a binary instance file: the latencies stay in the mapping, only bandwidths and capacities are copied
+// Prints the reason and leaves the task unchanged if the file is not a valid instance. The latencies are
+// inverted by freeze(), so one streaming pass rejects any validLatency() refuses, as importCsvInstance() does.
+// Time Complexity: O(S * C) for the latency check, sequential reads of the mapping
+// Space Complexity: O(S + C) resident, the S * C latencies are paged in from the file and can be evicted
+bool Task::loadInstance(const string& path)
+{
+    shared_ptr<MappedInstance> file = make_shared<MappedInstance>();
+    if (!file->open(path)) {
+        return false;
+    }
+    const InstanceHeader& header = file->header();
+    const double* latencies = file->latencies();
+    size_t numLatencies = (size_t)header.numServers * header.numClients;
+    for (size_t k = 0; k < numLatencies; k++) {
+        if (!validLatency(latencies[k])) {
+            cout << path << ": latency of server " << k / header.numClients << ", client " << k % header.numClients
+                 << " is " << latencies[k] << " (" INSTANCE_LATENCY_RULE ")" << endl;
+            return false;
+        }
+    }
+    this->numServers = header.numServers;
+    this->numClients = header.numClients;
+    this->latencyMatrix.clear();
+    this->latencyMatrix.shrink_to_fit();
+    this->sparse = false;
+    this->edgeStart.clear();
+    this->edgeClients.clear();
+    this->bandwithClients.assign(file->bandwidths(), file->bandwidths() + numClients);
+    this->capacityServers.assign(file->capacities(), file->capacities() + numServers);
+    this->mappedFile = file;
+    this->frozen = false;
+    return true;
+}
+
+// Writes the task as a binary instance file
+// Time Complexity: O(S * C)
+// Space Complexity: O(S + C)
+bool Task::saveInstance(const string& path)
+{
+    if (sparse) {
+        cout << "Sparse tasks cannot be saved in the dense instance format." << endl;
+        return false;
+    }
+    InstanceWriter writer;
+    if (numServers == 0 || numClients == 0 || !writer.open(path, numClients)) {
+        return false;
+    }
+    const double* matrix = latencies();
+    for (unsigned int i = 0; i < numServers; i++)
+    {
+        if (!writer.writeLatencyRow(matrix + (size_t)i * numClients)) {
+            break; // finish() reports the failure
+        }
+    }
+    vector<uint32_t> bandwidths(bandwithClients.begin(), bandwithClients.end());
+    vector<uint32_t> capacities(capacityServers.begin(), capacityServers.end());
+    return writer.finish(bandwidths, capacities);
+}
+
+#endif
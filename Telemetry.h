@@ -0,0 +1,293 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+// Structured per-generation telemetry
+// The solver pushes one GenerationStats record per generation into a bounded lock-free ring, a
+// background thread drains the ring into a JSONL or CSV file. Pushing never blocks and never does
+// I/O: if the writer falls a whole ring behind, records are dropped and counted instead.
+// Full solutions are not part of the stream, a dump of the best individual is printed only when
+// requestDump() asks for one.
+//
+// Constants and Macros:
+// - TELEMETRY_CAPACITY: Records the ring holds (rounded up to a power of two).
+// - TELEMETRY_FLUSH_MS: Milliseconds the writer sleeps when the ring is empty.
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+#define TELEMETRY_CAPACITY 4096
+#define TELEMETRY_FLUSH_MS 20
+
+using namespace std;
+
+// Statistics of one generation
+struct GenerationStats
+{
+    unsigned int island; // 0 outside the island model
+    unsigned int generation; // 0 -> initial population
+    double seconds; // Since the start of the run
+    double bestFitness;
+    double meanFitness;
+    double worstFitness;
+    double feasibleRatio; // Share of feasible individuals
+    double diversity; // populationDiversity(), NAN on the generations it is not measured
+    // Penalty breakdown of the best individual
+    double latencyScore;
+    double penaltyCapacity;
+    double penaltyBandwith;
+    double connectionPen;
+};
+
+// Output formats of a TelemetrySink
+enum TelemetryFormat
+{
+    TELEMETRY_JSONL = 1, // One JSON object per line
+    TELEMETRY_CSV = 2 // Header line, then one row per record
+};
+
+// Bounded multi-producer / single-consumer ring of telemetry records
+// Every slot carries a sequence number: producers claim a slot by moving the tail, write the record
+// and publish it through the slot's sequence, so islands can push concurrently without a lock.
+class StatsRing
+{
+    private:
+    struct Slot
+    {
+        atomic<size_t> sequence;
+        GenerationStats record;
+    };
+    vector<Slot> slots;
+    size_t mask; // Capacity - 1, the capacity is a power of two
+    atomic<size_t> tail; // Next slot to claim by a producer
+    size_t head; // Next slot to read, only touched by the consumer
+
+    public:
+    StatsRing(size_t capacity); // Constructor, allocates every slot.
+
+    // Methods
+    bool tryPush(const GenerationStats& record); // False if the ring is full.
+    bool tryPop(GenerationStats& record); // False if the ring is empty.
+};
+
+// Constructor
+// Time Complexity: O(K), K stands for capacity
+// Space Complexity: O(K)
+StatsRing::StatsRing(size_t capacity)
+{
+    size_t size = 1;
+    while (size < capacity) {
+        size <<= 1;
+    }
+    this->slots = vector<Slot>(size);
+    for (size_t k = 0; k < size; k++) {
+        this->slots[k].sequence.store(k, memory_order_relaxed);
+    }
+    this->mask = size - 1;
+    this->tail = 0;
+    this->head = 0;
+}
+
+// Producer side: a slot is free when its sequence equals the position being claimed
+// Time Complexity: O(1) expected, a CAS retry per concurrent producer
+// Space Complexity: O(1)
+bool StatsRing::tryPush(const GenerationStats& record)
+{
+    size_t position = tail.load(memory_order_relaxed);
+    while (true) {
+        Slot& slot = slots[position & mask];
+        size_t sequence = slot.sequence.load(memory_order_acquire);
+        if (sequence == position) {
+            if (tail.compare_exchange_weak(position, position + 1, memory_order_relaxed)) {
+                slot.record = record;
+                slot.sequence.store(position + 1, memory_order_release);
+                return true;
+            }
+        } else if (sequence < position) {
+            return false; // The consumer has not freed this slot yet: full
+        } else {
+            position = tail.load(memory_order_relaxed); // Another producer took it
+        }
+    }
+}
+
+// Consumer side: a slot is readable once its producer published position + 1
+// Time Complexity: O(1)
+// Space Complexity: O(1)
+bool StatsRing::tryPop(GenerationStats& record)
+{
+    Slot& slot = slots[head & mask];
+    if (slot.sequence.load(memory_order_acquire) != head + 1) {
+        return false;
+    }
+    record = slot.record;
+    slot.sequence.store(head + slots.size(), memory_order_release); // Free for the next lap
+    head++;
+    return true;
+}
+
+// Writes the records pushed by the solver to a file from a background thread
+class TelemetrySink
+{
+    private:
+    StatsRing ring;
+    FILE* file;
+    TelemetryFormat format;
+    thread writer; // Drains the ring into file
+    atomic<bool> stopping;
+    atomic<bool> dumpWanted; // Set by requestDump(), cleared by the solver
+    atomic<unsigned long long> droppedRecords;
+    atomic<unsigned long long> writtenRecords;
+
+    void writerLoop(); // Main function of the writer thread.
+    void write(const GenerationStats& record); // Formats one record.
+
+    public:
+    TelemetrySink(const string& path, TelemetryFormat format = TELEMETRY_JSONL, size_t capacity = TELEMETRY_CAPACITY); // Opens path and starts the writer.
+    ~TelemetrySink(); // Writes what is left in the ring, stops the writer and closes the file.
+
+    // Methods
+    bool isOpen() const; // False if the file could not be created.
+    void push(const GenerationStats& record); // Non-blocking, drops the record if the ring is full.
+    void requestDump(); // Asks the solver to print its best individual after the current generation.
+    bool takeDumpRequest(); // True once per requestDump(), called by the solver.
+    unsigned long long dropped() const; // Records lost because the ring was full.
+    unsigned long long written() const; // Records written so far.
+};
+
+// Constructor
+// Time Complexity: O(K)
+// Space Complexity: O(K)
+TelemetrySink::TelemetrySink(const string& path, TelemetryFormat format, size_t capacity)
+    : ring(capacity)
+{
+    this->format = format;
+    this->stopping = false;
+    this->dumpWanted = false;
+    this->droppedRecords = 0;
+    this->writtenRecords = 0;
+    this->file = fopen(path.c_str(), "w");
+    if (!file) {
+        cout << "Cannot create telemetry file " << path << endl;
+        return;
+    }
+    if (format == TELEMETRY_CSV) {
+        fprintf(file, "island,generation,seconds,best,mean,worst,feasible,diversity,latency,capacityPenalty,bandwidthPenalty,connectionPenalty\n");
+    }
+    writer = thread(&TelemetrySink::writerLoop, this);
+}
+
+// Destructor
+// Time Complexity: O(R), R stands for the records left in the ring
+// Space Complexity: O(1)
+TelemetrySink::~TelemetrySink()
+{
+    stopping = true;
+    if (writer.joinable()) {
+        writer.join();
+    }
+    if (file) {
+        fclose(file);
+    }
+}
+
+// Sleeps while the ring is empty, the last pass after stopping catches the final records
+// Time Complexity: O(R) over the whole run
+// Space Complexity: O(1)
+void TelemetrySink::writerLoop()
+{
+    GenerationStats record;
+    while (true) {
+        bool last = stopping.load(memory_order_acquire);
+        bool wrote = false;
+        while (ring.tryPop(record)) {
+            write(record);
+            wrote = true;
+        }
+        if (wrote) {
+            fflush(file);
+        }
+        if (last) {
+            return;
+        }
+        this_thread::sleep_for(chrono::milliseconds(TELEMETRY_FLUSH_MS));
+    }
+}
+
+// One JSON object or CSV row, a diversity that was not measured is null (JSONL) or empty (CSV)
+// Time Complexity: O(1)
+// Space Complexity: O(1)
+void TelemetrySink::write(const GenerationStats& record)
+{
+    char diversity[32] = "";
+    if (!std::isnan(record.diversity)) {
+        snprintf(diversity, sizeof(diversity), "%.6g", record.diversity);
+    } else if (format == TELEMETRY_JSONL) {
+        snprintf(diversity, sizeof(diversity), "null");
+    }
+
+    if (format == TELEMETRY_CSV) {
+        fprintf(file, "%u,%u,%.6f,%.17g,%.17g,%.17g,%.6g,%s,%.17g,%.17g,%.17g,%.17g\n",
+                record.island, record.generation, record.seconds, record.bestFitness, record.meanFitness,
+                record.worstFitness, record.feasibleRatio, diversity, record.latencyScore,
+                record.penaltyCapacity, record.penaltyBandwith, record.connectionPen);
+    } else {
+        fprintf(file, "{\"island\":%u,\"generation\":%u,\"seconds\":%.6f,\"best\":%.17g,\"mean\":%.17g,\"worst\":%.17g,"
+                "\"feasible\":%.6g,\"diversity\":%s,\"latency\":%.17g,\"capacityPenalty\":%.17g,"
+                "\"bandwidthPenalty\":%.17g,\"connectionPenalty\":%.17g}\n",
+                record.island, record.generation, record.seconds, record.bestFitness, record.meanFitness,
+                record.worstFitness, record.feasibleRatio, diversity, record.latencyScore,
+                record.penaltyCapacity, record.penaltyBandwith, record.connectionPen);
+    }
+    writtenRecords.fetch_add(1, memory_order_relaxed);
+}
+
+// Time Complexity: O(1)
+// Space Complexity: O(1)
+bool TelemetrySink::isOpen() const
+{
+    return file != nullptr;
+}
+
+// Time Complexity: O(1)
+// Space Complexity: O(1)
+void TelemetrySink::push(const GenerationStats& record)
+{
+    if (!file || !ring.tryPush(record)) {
+        droppedRecords.fetch_add(1, memory_order_relaxed);
+    }
+}
+
+// Time Complexity: O(1)
+// Space Complexity: O(1)
+void TelemetrySink::requestDump()
+{
+    dumpWanted.store(true, memory_order_relaxed);
+}
+
+// Time Complexity: O(1)
+// Space Complexity: O(1)
+bool TelemetrySink::takeDumpRequest()
+{
+    return dumpWanted.load(memory_order_relaxed) && dumpWanted.exchange(false, memory_order_relaxed);
+}
+
+// Time Complexity: O(1)
+// Space Complexity: O(1)
+unsigned long long TelemetrySink::dropped() const
+{
+    return droppedRecords.load(memory_order_relaxed);
+}
+
+// Time Complexity: O(1)
+// Space Complexity: O(1)
+unsigned long long TelemetrySink::written() const
+{
+    return writtenRecords.load(memory_order_relaxed);
+}
+
+#endif
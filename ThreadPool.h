@@ -0,0 +1,169 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+// Fixed-size pool of worker threads used to split population-wide loops.
+// The pool is created once per run and reused by every generation, so the
+// only per-call cost is waking the workers up.
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+class ThreadPool
+{
+    private:
+    vector<thread> workers; // Background threads, the calling thread is the extra one.
+    mutex submitMutex; // Serializes parallelFor calls coming from different threads.
+    mutex stateMutex; // Protects the job description below.
+    condition_variable wakeUp; // Signals workers that a new job is available.
+    condition_variable jobDone; // Signals the caller that every worker finished.
+    const void* job; // Body of the current loop, type-erased without allocating.
+    void (*jobInvoke)(const void*, size_t, size_t); // Calls job on a [begin, end) chunk.
+    size_t jobCount; // Number of iterations of the current loop.
+    size_t chunkSize; // Iterations claimed at once.
+    atomic<size_t> nextIndex; // First iteration that has not been claimed yet.
+    unsigned long long jobId; // Incremented for every new loop.
+    unsigned int activeWorkers; // Workers still running the current loop.
+    bool stopping; // Set by the destructor.
+
+    void workerLoop(); // Main function of each worker.
+    void runChunks(); // Claims and runs chunks until the loop is exhausted.
+
+    public:
+    ThreadPool(unsigned int numThreads); // Constructor, 0 -> one thread per hardware thread.
+    ~ThreadPool(); // Joins all workers.
+
+    // Methods
+    unsigned int size(); // Number of threads taking part in a loop, caller included.
+    template <class Body>
+    void parallelFor(size_t count, const Body& body); // Runs body(begin, end) on chunks of [0, count).
+};
+
+// Constructor: starts numThreads - 1 workers, the caller of parallelFor is the last one
+// Time Complexity: O(T), T stands for number of threads
+// Space Complexity: O(T)
+ThreadPool::ThreadPool(unsigned int numThreads)
+{
+    if (numThreads == 0) {
+        numThreads = max(1u, thread::hardware_concurrency());
+    }
+    this->job = nullptr;
+    this->jobInvoke = nullptr;
+    this->jobCount = 0;
+    this->chunkSize = 1;
+    this->nextIndex = 0;
+    this->jobId = 0;
+    this->activeWorkers = 0;
+    this->stopping = false;
+
+    for (unsigned int i = 1; i < numThreads; i++) {
+        workers.emplace_back(&ThreadPool::workerLoop, this);
+    }
+}
+
+// Destructor: wakes every worker up and waits for them to exit
+// Time Complexity: O(T)
+// Space Complexity: O(1)
+ThreadPool::~ThreadPool()
+{
+    {
+        lock_guard<mutex> lock(stateMutex);
+        stopping = true;
+    }
+    wakeUp.notify_all();
+    for (thread& worker : workers) {
+        worker.join();
+    }
+}
+
+// Number of threads that execute a loop
+// Time Complexity: O(1)
+// Space Complexity: O(1)
+unsigned int ThreadPool::size()
+{
+    return workers.size() + 1;
+}
+
+// Splits [0, count) into chunks and runs them on all threads, returns when every chunk is done.
+// body must only touch data owned by its own [begin, end) range.
+// The body is referenced, not copied into a std::function, so a call never allocates.
+// Time Complexity: O(count / T) per thread plus the cost of body
+// Space Complexity: O(1)
+template <class Body>
+void ThreadPool::parallelFor(size_t count, const Body& body)
+{
+    if (count == 0) {
+        return;
+    }
+    if (workers.empty() || count == 1) {
+        body(0, count);
+        return;
+    }
+
+    lock_guard<mutex> submit(submitMutex);
+    {
+        lock_guard<mutex> lock(stateMutex);
+        job = &body;
+        jobInvoke = [](const void* target, size_t begin, size_t end) {
+            (*static_cast<const Body*>(target))(begin, end);
+        };
+        jobCount = count;
+        // A few chunks per thread keeps the threads busy when iterations have uneven cost
+        chunkSize = max<size_t>(1, count / (4 * size()));
+        nextIndex = 0;
+        activeWorkers = workers.size();
+        jobId++;
+    }
+    wakeUp.notify_all();
+
+    runChunks();
+
+    unique_lock<mutex> lock(stateMutex);
+    jobDone.wait(lock, [this] { return activeWorkers == 0; });
+    job = nullptr;
+}
+
+// Claims chunks of the current loop until none are left
+// Time Complexity: O(count / T) chunks on average
+// Space Complexity: O(1)
+void ThreadPool::runChunks()
+{
+    while (true) {
+        size_t begin = nextIndex.fetch_add(chunkSize);
+        if (begin >= jobCount) {
+            break;
+        }
+        jobInvoke(job, begin, min(begin + chunkSize, jobCount));
+    }
+}
+
+// Worker main loop: sleeps until a new loop is published, helps running it, reports back
+// Time Complexity: O(1) per loop besides the chunks it runs
+// Space Complexity: O(1)
+void ThreadPool::workerLoop()
+{
+    unsigned long long seen = 0;
+    while (true) {
+        unique_lock<mutex> lock(stateMutex);
+        wakeUp.wait(lock, [this, seen] { return stopping || jobId != seen; });
+        if (stopping) {
+            return;
+        }
+        seen = jobId;
+        lock.unlock();
+
+        runChunks();
+
+        lock.lock();
+        if (--activeWorkers == 0) {
+            jobDone.notify_one();
+        }
+    }
+}
+
+#endif